@@ -0,0 +1,86 @@
+// 建连基准测试：多个客户端线程并发地建立连接、发送一条PING并等待响应后关闭连接，
+// 统计服务端每秒可接受的连接数与建连延迟分位数，用于对比reusePort开启与关闭时的表现
+// 用法：accept_benchmark [host] [port] [threadNum] [connPerThread]
+#include "asio.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace foxbatdb::benchmark {
+    using Clock = std::chrono::steady_clock;
+
+    struct WorkerResult {
+        std::vector<double> latencyUs;// 自发起连接至收到PING响应的耗时
+        std::size_t failed = 0;
+    };
+
+    void Worker(const asio::ip::tcp::endpoint& endpoint, std::size_t connNum, WorkerResult& result) {
+        static constexpr std::string_view PING = "*1\r\n$4\r\nPING\r\n";
+        asio::io_context ioCtx;
+        char reply[64];
+
+        result.latencyUs.reserve(connNum);
+        for (std::size_t i = 0; i < connNum; ++i) {
+            auto start = Clock::now();
+            asio::error_code ec;
+            asio::ip::tcp::socket socket{ioCtx};
+            socket.connect(endpoint, ec);
+            if (!ec) asio::write(socket, asio::buffer(PING), ec);
+            if (!ec) socket.read_some(asio::buffer(reply), ec);
+            if (ec) {
+                ++result.failed;
+                continue;
+            }
+            result.latencyUs.emplace_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+            socket.close(ec);
+        }
+    }
+
+    double Percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0;
+        auto idx = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1));
+        return sorted[idx];
+    }
+}// namespace foxbatdb::benchmark
+
+int main(int argc, char** argv) {
+    using namespace foxbatdb::benchmark;
+
+    std::string host = (argc > 1) ? argv[1] : "127.0.0.1";
+    auto port = static_cast<std::uint16_t>((argc > 2) ? std::strtoul(argv[2], nullptr, 10) : 7698);
+    std::size_t threadNum = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 8;
+    std::size_t connPerThread = (argc > 4) ? std::strtoull(argv[4], nullptr, 10) : 2000;
+
+    asio::ip::tcp::endpoint endpoint{asio::ip::make_address(host), port};
+    std::vector<WorkerResult> results(threadNum);
+    std::vector<std::thread> threads;
+    threads.reserve(threadNum);
+
+    auto start = Clock::now();
+    for (std::size_t i = 0; i < threadNum; ++i)
+        threads.emplace_back(Worker, std::cref(endpoint), connPerThread, std::ref(results[i]));
+    for (auto& thread: threads)
+        thread.join();
+    auto sec = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> latency;
+    std::size_t failed = 0;
+    for (auto& r: results) {
+        latency.insert(latency.end(), r.latencyUs.begin(), r.latencyUs.end());
+        failed += r.failed;
+    }
+    std::sort(latency.begin(), latency.end());
+
+    std::printf("%8s %10s %8s %12s %10s %10s %10s\n",
+                "threads", "conns", "failed", "conns/s", "p50 us", "p99 us", "max us");
+    std::printf("%8zu %10zu %8zu %12.0f %10.1f %10.1f %10.1f\n",
+                threadNum, latency.size(), failed, static_cast<double>(latency.size()) / sec,
+                Percentile(latency, 0.5), Percentile(latency, 0.99), latency.empty() ? 0.0 : latency.back());
+    return 0;
+}
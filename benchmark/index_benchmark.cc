@@ -0,0 +1,267 @@
+// 内存索引结构基准测试：对比HAT-trie、ART、有序树（std::map）与Swiss table哈希表的插入、点查、前缀查询吞吐量及每个key的内存占用
+// 用法：index_benchmark [keyNum] [keyFile]，keyFile为每行一个key的真实key样本
+#include "core/art.h"
+#include "core/swisstable.h"
+#include "tsl/htrie_map.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // 统计堆内存占用，用于计算每个key的平均内存开销
+    std::atomic<std::int64_t> gAllocatedBytes{0};
+    constexpr std::size_t ALLOC_HEADER_SIZE = alignof(std::max_align_t);
+}// namespace
+
+void* operator new(std::size_t size) {
+    auto* p = static_cast<char*>(std::malloc(size + ALLOC_HEADER_SIZE));
+    if (!p) throw std::bad_alloc{};
+    *reinterpret_cast<std::size_t*>(p) = size;
+    gAllocatedBytes.fetch_add(static_cast<std::int64_t>(size), std::memory_order_relaxed);
+    return p + ALLOC_HEADER_SIZE;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    auto* p = static_cast<char*>(ptr) - ALLOC_HEADER_SIZE;
+    gAllocatedBytes.fetch_sub(static_cast<std::int64_t>(*reinterpret_cast<std::size_t*>(p)), std::memory_order_relaxed);
+    std::free(p);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept {
+    operator delete(ptr);
+}
+
+namespace foxbatdb::benchmark {
+    struct KeySet {
+        std::string name;
+        std::vector<std::string> keys;
+        std::vector<std::string> prefixes;
+    };
+
+    struct Result {
+        double insertMops;
+        double getMops;
+        double prefixKops;
+        double bytesPerKey;
+        std::size_t checksum;// 防止编译器优化掉查询
+    };
+
+    std::string RandomString(std::mt19937_64& rng, std::size_t len) {
+        static constexpr std::string_view CHARSET = "0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        std::string s(len, '\0');
+        for (auto& c: s) c = CHARSET[rng() % CHARSET.size()];
+        return s;
+    }
+
+    std::vector<std::string> SamplePrefixes(const std::vector<std::string>& keys, std::mt19937_64& rng,
+                                            const std::function<std::string(const std::string&)>& toPrefix) {
+        static constexpr std::size_t PREFIX_QUERY_NUM = 1000;
+        std::vector<std::string> prefixes;
+        prefixes.reserve(PREFIX_QUERY_NUM);
+        for (std::size_t i = 0; i < PREFIX_QUERY_NUM; ++i)
+            prefixes.emplace_back(toPrefix(keys[rng() % keys.size()]));
+        return prefixes;
+    }
+
+    KeySet RandomKeys(std::size_t n, std::mt19937_64& rng) {
+        KeySet set{.name = "random"};
+        for (std::size_t i = 0; i < n; ++i)
+            set.keys.emplace_back(RandomString(rng, 16 + rng() % 17));
+        set.prefixes = SamplePrefixes(set.keys, rng, [](const std::string& k) { return k.substr(0, 3); });
+        return set;
+    }
+
+    // tenant:region:entity:id形式，共享较长的前缀
+    KeySet HierarchicalKeys(std::size_t n, std::mt19937_64& rng) {
+        static const char* ENTITIES[] = {"user", "order", "session", "invoice", "device"};
+        KeySet set{.name = "tenant:region:entity:id"};
+        char buf[128];
+        for (std::size_t i = 0; i < n; ++i) {
+            std::snprintf(buf, sizeof(buf), "tenant%04u:region-%02u:%s:%012llu",
+                          static_cast<unsigned>(rng() % 200), static_cast<unsigned>(rng() % 16),
+                          ENTITIES[rng() % 5], static_cast<unsigned long long>(rng() % 1000000000000ULL));
+            set.keys.emplace_back(buf);
+        }
+        set.prefixes = SamplePrefixes(set.keys, rng, [](const std::string& k) {
+            return k.substr(0, k.find(':', k.find(':') + 1) + 1);// tenant:region:
+        });
+        return set;
+    }
+
+    KeySet SequentialKeys(std::size_t n, std::mt19937_64& rng) {
+        KeySet set{.name = "sequential"};
+        char buf[64];
+        for (std::size_t i = 0; i < n; ++i) {
+            std::snprintf(buf, sizeof(buf), "user:%010zu", i);
+            set.keys.emplace_back(buf);
+        }
+        set.prefixes = SamplePrefixes(set.keys, rng, [](const std::string& k) { return k.substr(0, k.size() - 2); });
+        return set;
+    }
+
+    KeySet FileKeys(const std::string& path, std::size_t n, std::mt19937_64& rng) {
+        KeySet set{.name = "file:" + path};
+        std::ifstream in{path};
+        std::string line;
+        while ((set.keys.size() < n) && std::getline(in, line)) {
+            if (!line.empty()) set.keys.emplace_back(std::move(line));
+        }
+        if (!set.keys.empty())
+            set.prefixes = SamplePrefixes(set.keys, rng, [](const std::string& k) { return k.substr(0, k.size() / 2); });
+        return set;
+    }
+
+    template<typename F>
+    double ElapsedSeconds(F&& f) {
+        auto start = std::chrono::steady_clock::now();
+        f();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 各索引结构的统一适配层
+    struct HATTrieAdapter {
+        static constexpr const char* NAME = "hat-trie";
+        static constexpr bool SUPPORT_PREFIX = true;
+        tsl::htrie_map<char, std::uint64_t> tree;
+
+        void Insert(const std::string& k, std::uint64_t v) { tree.insert(k, v); }
+        const std::uint64_t* Find(const std::string& k) const {
+            auto it = tree.find(k);
+            return (it == tree.end()) ? nullptr : &it.value();
+        }
+        std::size_t PrefixCount(const std::string& p) const {
+            std::size_t n = 0;
+            auto range = tree.equal_prefix_range(p);
+            for (auto it = range.first; it != range.second; ++it) n += it.value() & 1;
+            return n;
+        }
+    };
+
+    struct ARTAdapter {
+        static constexpr const char* NAME = "art";
+        static constexpr bool SUPPORT_PREFIX = true;
+        AdaptiveRadixTree<std::uint64_t> tree;
+
+        void Insert(const std::string& k, std::uint64_t v) { tree.InsertOrAssign(k, v); }
+        const std::uint64_t* Find(const std::string& k) const { return tree.Find(k); }
+        std::size_t PrefixCount(const std::string& p) const {
+            std::size_t n = 0;
+            tree.ForEachWithPrefix(p, [&n](const std::string&, std::uint64_t v) {
+                n += v & 1;
+                return true;
+            });
+            return n;
+        }
+    };
+
+    struct OrderedAdapter {
+        static constexpr const char* NAME = "ordered";
+        static constexpr bool SUPPORT_PREFIX = true;
+        std::map<std::string, std::uint64_t, std::less<>> tree;
+
+        void Insert(const std::string& k, std::uint64_t v) { tree.insert_or_assign(k, v); }
+        const std::uint64_t* Find(const std::string& k) const {
+            auto it = tree.find(k);
+            return (it == tree.end()) ? nullptr : &it->second;
+        }
+        std::size_t PrefixCount(const std::string& p) const {
+            std::size_t n = 0;
+            for (auto it = tree.lower_bound(p); (it != tree.end()) && it->first.starts_with(p); ++it)
+                n += it->second & 1;
+            return n;
+        }
+    };
+
+    struct HashAdapter {
+        static constexpr const char* NAME = "hash";
+        static constexpr bool SUPPORT_PREFIX = false;
+        SwissTable<std::uint64_t> table;
+
+        void Insert(const std::string& k, std::uint64_t v) { table.InsertOrAssign(k, v); }
+        const std::uint64_t* Find(const std::string& k) const { return table.Find(k); }
+        std::size_t PrefixCount(const std::string&) const { return 0; }
+    };
+
+    template<typename Adapter>
+    Result Run(const KeySet& set, const std::vector<std::string>& lookupOrder) {
+        Result result{};
+        auto bytesBefore = gAllocatedBytes.load();
+        {
+            Adapter index;
+            auto insertSec = ElapsedSeconds([&] {
+                for (std::size_t i = 0; i < set.keys.size(); ++i)
+                    index.Insert(set.keys[i], i);
+            });
+            result.bytesPerKey = static_cast<double>(gAllocatedBytes.load() - bytesBefore) /
+                                 static_cast<double>(set.keys.size());
+
+            auto getSec = ElapsedSeconds([&] {
+                for (const auto& k: lookupOrder) {
+                    if (auto* v = index.Find(k); v) result.checksum += *v;
+                }
+            });
+
+            result.insertMops = static_cast<double>(set.keys.size()) / insertSec / 1e6;
+            result.getMops = static_cast<double>(lookupOrder.size()) / getSec / 1e6;
+
+            if constexpr (Adapter::SUPPORT_PREFIX) {
+                auto prefixSec = ElapsedSeconds([&] {
+                    for (const auto& p: set.prefixes)
+                        result.checksum += index.PrefixCount(p);
+                });
+                result.prefixKops = static_cast<double>(set.prefixes.size()) / prefixSec / 1e3;
+            }
+        }
+        return result;
+    }
+
+    template<typename Adapter>
+    void Report(const KeySet& set, const std::vector<std::string>& lookupOrder) {
+        auto r = Run<Adapter>(set, lookupOrder);
+        char prefixKops[32] = "n/a";// 不支持前缀查找的索引不参与该项
+        if (Adapter::SUPPORT_PREFIX)
+            std::snprintf(prefixKops, sizeof(prefixKops), "%.2f", r.prefixKops);
+        std::printf("%-28s %-10s %12.2f %12.2f %14s %12.1f  (checksum %zu)\n",
+                    set.name.c_str(), Adapter::NAME, r.insertMops, r.getMops, prefixKops, r.bytesPerKey,
+                    r.checksum);
+    }
+
+    void RunAll(const KeySet& set, std::mt19937_64& rng) {
+        if (set.keys.empty()) return;
+
+        auto lookupOrder = set.keys;
+        std::shuffle(lookupOrder.begin(), lookupOrder.end(), rng);
+
+        Report<HATTrieAdapter>(set, lookupOrder);
+        Report<ARTAdapter>(set, lookupOrder);
+        Report<OrderedAdapter>(set, lookupOrder);
+        Report<HashAdapter>(set, lookupOrder);
+    }
+}// namespace foxbatdb::benchmark
+
+int main(int argc, char** argv) {
+    using namespace foxbatdb::benchmark;
+
+    std::size_t keyNum = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::mt19937_64 rng{20240601};
+
+    std::printf("%-28s %-10s %12s %12s %14s %12s\n",
+                "distribution", "index", "insert Mops", "get Mops", "prefix Kqps", "bytes/key");
+    RunAll(RandomKeys(keyNum, rng), rng);
+    RunAll(HierarchicalKeys(keyNum, rng), rng);
+    RunAll(SequentialKeys(keyNum, rng), rng);
+    if (argc > 2)
+        RunAll(FileKeys(argv[2], keyNum, rng), rng);
+    return 0;
+}
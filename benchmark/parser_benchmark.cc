@@ -0,0 +1,122 @@
+// RESP请求解析基准测试：统计仅切分帧（RunFrame）与完整解析为命令（Run）的吞吐量，
+// 覆盖不同value大小、pipeline批量请求以及按小块分批到达的请求
+// 用法：parser_benchmark [cmdNum] [chunkSize]
+#include "frontend/parser.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace foxbatdb::benchmark {
+    struct Result {
+        double mbps;
+        double mcmds;
+        std::size_t checksum;// 防止编译器优化掉解析
+    };
+
+    std::string EncodeCommand(const std::vector<std::string>& params) {
+        std::string out = "*" + std::to_string(params.size()) + "\r\n";
+        for (const auto& p: params) {
+            out += "$" + std::to_string(p.size()) + "\r\n";
+            out += p;
+            out += "\r\n";
+        }
+        return out;
+    }
+
+    // cmdNum条SET命令首尾相接，模拟一次读取到的pipeline请求
+    std::string BuildPipeline(std::size_t cmdNum, std::size_t valueSize) {
+        std::string value(valueSize, 'v');
+        std::string buf;
+        for (std::size_t i = 0; i < cmdNum; ++i)
+            buf += EncodeCommand({"SET", "key:" + std::to_string(i), value});
+        return buf;
+    }
+
+    double ElapsedSeconds(const std::function<void()>& fn) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // chunkSize为0时整段缓冲区一次交给解析器，否则每次只追加chunkSize字节，模拟TCP分段到达
+    template<bool FULL>
+    Result Run(const std::string& input, std::size_t cmdNum, std::size_t chunkSize, std::size_t rounds) {
+        Result result{};
+        RequestParser parser;
+        std::vector<std::string_view> params;
+        std::size_t parsed = 0;
+
+        auto parseOne = [&](std::string_view view, std::size_t& consumed) {
+            if constexpr (FULL) {
+                std::error_code ec;
+                {
+                    auto r = parser.Run(view, consumed);
+                    result.checksum += r.data.argv.size();
+                    ec = r.ec;
+                }
+                parser.ResetArena();
+                return ec;
+            } else {
+                auto ec = parser.RunFrame(view, consumed, params);
+                result.checksum += params.size();
+                return ec;
+            }
+        };
+
+        auto sec = ElapsedSeconds([&] {
+            for (std::size_t r = 0; r < rounds; ++r) {
+                std::size_t begin = 0;
+                std::size_t end = chunkSize ? 0 : input.size();
+                while (begin < input.size()) {
+                    if (chunkSize) end = std::min(input.size(), end + chunkSize);
+                    while (begin < end) {
+                        std::size_t consumed = 0;
+                        auto ec = parseOne(std::string_view{input}.substr(begin, end - begin), consumed);
+                        begin += consumed;
+                        if (error::ProtocolErrorCode::kContinue == ec) break;
+                        ++parsed;
+                    }
+                }
+            }
+        });
+
+        result.mbps = static_cast<double>(input.size() * rounds) / sec / (1024.0 * 1024.0);
+        result.mcmds = static_cast<double>(cmdNum * rounds) / sec / 1e6;
+        if (parsed != cmdNum * rounds)
+            std::fprintf(stderr, "parsed %zu commands, expected %zu\n", parsed, cmdNum * rounds);
+        return result;
+    }
+
+    void Report(const char* name, std::size_t cmdNum, std::size_t valueSize, std::size_t chunkSize) {
+        auto input = BuildPipeline(cmdNum, valueSize);
+        // 每组用例总计约解析256MB数据
+        auto rounds = std::max<std::size_t>(1, (256ULL << 20) / input.size());
+        auto frame = Run<false>(input, cmdNum, chunkSize, rounds);
+        auto full = Run<true>(input, cmdNum, chunkSize, rounds);
+        std::printf("%-24s %10zu %8zu %12.1f %12.2f %12.1f %12.2f  (checksum %zu)\n",
+                    name, valueSize, chunkSize, frame.mbps, frame.mcmds, full.mbps, full.mcmds,
+                    frame.checksum + full.checksum);
+    }
+}// namespace foxbatdb::benchmark
+
+int main(int argc, char** argv) {
+    using namespace foxbatdb::benchmark;
+
+    std::size_t cmdNum = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1024;
+    std::size_t chunkSize = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 1460;// 以太网下单个TCP分段的典型载荷
+
+    std::printf("%-24s %10s %8s %12s %12s %12s %12s\n",
+                "case", "value size", "chunk", "frame MB/s", "frame Mcmd/s", "full MB/s", "full Mcmd/s");
+    Report("single SET", 1, 16, 0);
+    for (std::size_t valueSize: {16, 256, 4096, 65536})
+        Report("pipelined SET", cmdNum, valueSize, 0);
+    for (std::size_t valueSize: {16, 4096, 65536})
+        Report("pipelined SET, chunked", cmdNum, valueSize, chunkSize);
+    return 0;
+}
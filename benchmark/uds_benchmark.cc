@@ -0,0 +1,112 @@
+// 本机传输延迟基准测试：多个客户端各持有一个连接，交替发送SET与GET并同步等待响应（不使用pipeline），
+// 分别经TCP回环与Unix域socket连接服务端，统计往返延迟分位数与吞吐量；服务端须同时开启listenPort与unixSocketPath
+// 用法：uds_benchmark [port] [unixSocketPath] [clientNum] [requestsPerClient]
+#include "asio.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace foxbatdb::benchmark {
+    using Clock = std::chrono::steady_clock;
+
+    struct ClientResult {
+        std::vector<double> latencyUs;// 单个请求的往返耗时
+        std::size_t failed = 0;
+    };
+
+    std::string BuildCommand(const std::vector<std::string>& args) {
+        std::string cmd = "*" + std::to_string(args.size()) + "\r\n";
+        for (const auto& arg: args)
+            cmd += "$" + std::to_string(arg.size()) + "\r\n" + arg + "\r\n";
+        return cmd;
+    }
+
+    // 请求与响应均很短，一次read_some即可读到完整响应
+    template<typename Protocol>
+    void Client(const typename Protocol::endpoint& endpoint, std::size_t id, std::size_t requestNum,
+                ClientResult& result) {
+        asio::io_context ioCtx;
+        typename Protocol::socket socket{ioCtx};
+        asio::error_code ec;
+        socket.connect(endpoint, ec);
+        if (ec) {
+            result.failed = requestNum;
+            return;
+        }
+
+        auto key = "uds_benchmark:" + std::to_string(id);
+        const std::string set = BuildCommand({"SET", key, std::string(32, 'v')});
+        const std::string get = BuildCommand({"GET", key});
+        char reply[256];
+
+        result.latencyUs.reserve(requestNum);
+        for (std::size_t i = 0; i < requestNum; ++i) {
+            const auto& cmd = (i % 2) ? get : set;
+            auto start = Clock::now();
+            asio::write(socket, asio::buffer(cmd), ec);
+            if (!ec) socket.read_some(asio::buffer(reply), ec);
+            if (ec) {
+                result.failed += requestNum - i;
+                return;
+            }
+            result.latencyUs.emplace_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+    }
+
+    double Percentile(const std::vector<double>& sorted, double p) {
+        if (sorted.empty()) return 0;
+        auto idx = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1));
+        return sorted[idx];
+    }
+
+    template<typename Protocol>
+    void Run(const char* name, const typename Protocol::endpoint& endpoint, std::size_t clientNum,
+             std::size_t requestsPerClient) {
+        std::vector<ClientResult> results(clientNum);
+        std::vector<std::thread> threads;
+        threads.reserve(clientNum);
+
+        auto start = Clock::now();
+        for (std::size_t i = 0; i < clientNum; ++i)
+            threads.emplace_back(Client<Protocol>, std::cref(endpoint), i, requestsPerClient, std::ref(results[i]));
+        for (auto& thread: threads)
+            thread.join();
+        auto sec = std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::vector<double> latency;
+        std::size_t failed = 0;
+        for (auto& r: results) {
+            latency.insert(latency.end(), r.latencyUs.begin(), r.latencyUs.end());
+            failed += r.failed;
+        }
+        std::sort(latency.begin(), latency.end());
+
+        std::printf("%6s %10zu %8zu %12.0f %10.1f %10.1f %10.1f\n",
+                    name, latency.size(), failed, static_cast<double>(latency.size()) / sec,
+                    Percentile(latency, 0.5), Percentile(latency, 0.99), latency.empty() ? 0.0 : latency.back());
+    }
+}// namespace foxbatdb::benchmark
+
+int main(int argc, char** argv) {
+    using namespace foxbatdb::benchmark;
+
+    auto port = static_cast<std::uint16_t>((argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 7698);
+    std::string path = (argc > 2) ? argv[2] : "/tmp/foxbatdb.sock";
+    std::size_t clientNum = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 4;
+    std::size_t requestsPerClient = (argc > 4) ? std::strtoull(argv[4], nullptr, 10) : 100000;
+
+    std::printf("%6s %10s %8s %12s %10s %10s %10s\n",
+                "trans", "requests", "failed", "requests/s", "p50 us", "p99 us", "max us");
+    Run<asio::ip::tcp>("tcp", {asio::ip::make_address("127.0.0.1"), port}, clientNum, requestsPerClient);
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+    Run<asio::local::stream_protocol>("uds", asio::local::stream_protocol::endpoint{path}, clientNum, requestsPerClient);
+#else
+    std::printf("unix domain socket is not supported on this platform\n");
+#endif
+    return 0;
+}
@@ -0,0 +1,694 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define FOXBATDB_ART_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace foxbatdb {
+    // 自适应基数树（Adaptive Radix Tree）
+    // 内部节点按子节点数量在Node4/16/48/256间自动伸缩，并做完整路径压缩；
+    // 以字节的无符号值排序子节点，中序遍历即为key的字典序
+    // 内部节点额外持有一个terminal叶子，保存恰好在该节点处结束的key，因此key可为任意二进制串
+    template<typename T>
+    class AdaptiveRadixTree {
+    private:
+        enum class NodeType : std::uint8_t {
+            kLeaf,
+            kNode4,
+            kNode16,
+            kNode48,
+            kNode256
+        };
+
+        struct Node {
+            NodeType type;
+        };
+
+        struct Leaf : Node {
+            std::string key;
+            T value;
+        };
+
+        struct InnerNode : Node {
+            std::uint16_t childNum = 0;
+            Leaf* terminal = nullptr;
+            std::string prefix;
+        };
+
+        struct Node4 : InnerNode {
+            std::uint8_t keys[4];
+            Node* children[4];
+        };
+
+        struct Node16 : InnerNode {
+            std::uint8_t keys[16];
+            Node* children[16];
+        };
+
+        struct Node48 : InnerNode {
+            static constexpr std::uint8_t EMPTY = 0;
+            std::uint8_t childIndex[256];// 存储下标+1，0表示不存在
+            Node* children[48];
+        };
+
+        struct Node256 : InnerNode {
+            Node* children[256];
+        };
+
+        Node* mRoot_ = nullptr;
+        std::size_t mSize_ = 0;
+
+    public:
+        AdaptiveRadixTree() = default;
+        AdaptiveRadixTree(const AdaptiveRadixTree&) = delete;
+        AdaptiveRadixTree& operator=(const AdaptiveRadixTree&) = delete;
+        AdaptiveRadixTree(AdaptiveRadixTree&& rhs) noexcept
+            : mRoot_{std::exchange(rhs.mRoot_, nullptr)}, mSize_{std::exchange(rhs.mSize_, 0)} {}
+        AdaptiveRadixTree& operator=(AdaptiveRadixTree&& rhs) noexcept {
+            if (this != &rhs) {
+                Clear();
+                mRoot_ = std::exchange(rhs.mRoot_, nullptr);
+                mSize_ = std::exchange(rhs.mSize_, 0);
+            }
+            return *this;
+        }
+        ~AdaptiveRadixTree() { Clear(); }
+
+        [[nodiscard]] std::size_t Size() const { return mSize_; }
+
+        void Clear() {
+            FreeNode(mRoot_);
+            mRoot_ = nullptr;
+            mSize_ = 0;
+        }
+
+        [[nodiscard]] const T* Find(std::string_view key) const {
+            const Node* node = mRoot_;
+            std::size_t depth = 0;
+            while (node) {
+                if (NodeType::kLeaf == node->type) {
+                    auto* leaf = static_cast<const Leaf*>(node);
+                    return (leaf->key == key) ? &leaf->value : nullptr;
+                }
+
+                auto* inner = static_cast<const InnerNode*>(node);
+                if (!MatchPrefix(inner->prefix, key, depth))
+                    return nullptr;
+                depth += inner->prefix.size();
+                if (depth == key.size())
+                    return inner->terminal ? &inner->terminal->value : nullptr;
+
+                auto* child = FindChild(const_cast<InnerNode*>(inner), static_cast<std::uint8_t>(key[depth]));
+                node = child ? *child : nullptr;
+                ++depth;
+            }
+            return nullptr;
+        }
+
+        T* Find(std::string_view key) {
+            return const_cast<T*>(std::as_const(*this).Find(key));
+        }
+
+        // 返回true表示插入了新key，false表示覆盖了已有key的value
+        bool InsertOrAssign(std::string_view key, T value) {
+            bool inserted = Insert(mRoot_, key, 0, std::move(value));
+            if (inserted) ++mSize_;
+            return inserted;
+        }
+
+        bool Erase(std::string_view key) {
+            bool erased = Erase(mRoot_, key, 0);
+            if (erased) --mSize_;
+            return erased;
+        }
+
+        // 按字典序遍历，visitor返回false时终止
+        template<typename Visitor>
+        void ForEach(Visitor&& visitor) const {
+            std::string path;
+            VisitRange(mRoot_, path, nullptr, nullptr, false, visitor);
+        }
+
+        template<typename Visitor>
+        void ForEachWithPrefix(std::string_view prefix, Visitor&& visitor) const {
+            const Node* node = mRoot_;
+            std::size_t depth = 0;
+            while (node) {
+                if (NodeType::kLeaf == node->type) {
+                    auto* leaf = static_cast<const Leaf*>(node);
+                    if (leaf->key.starts_with(prefix))
+                        visitor(leaf->key, leaf->value);
+                    return;
+                }
+
+                auto* inner = static_cast<const InnerNode*>(node);
+                auto n = std::min(prefix.size() - depth, inner->prefix.size());
+                if (0 != prefix.compare(depth, n, inner->prefix, 0, n))
+                    return;
+                if (depth + inner->prefix.size() >= prefix.size()) {
+                    // 前缀在当前节点处耗尽，整棵子树均匹配
+                    std::string path;
+                    VisitRange(node, path, nullptr, nullptr, false, visitor);
+                    return;
+                }
+
+                depth += inner->prefix.size();
+                auto* child = FindChild(const_cast<InnerNode*>(inner), static_cast<std::uint8_t>(prefix[depth]));
+                node = child ? *child : nullptr;
+                ++depth;
+            }
+        }
+
+        // 遍历闭区间[lo, hi]，边界为nullptr时表示无界
+        template<typename Visitor>
+        void ForEachInRange(const std::string* lo, const std::string* hi, bool reverse, Visitor&& visitor) const {
+            std::string path;
+            VisitRange(mRoot_, path, lo, hi, reverse, visitor);
+        }
+
+    private:
+        static bool MatchPrefix(const std::string& prefix, std::string_view key, std::size_t depth) {
+            if (key.size() < depth + prefix.size()) return false;
+            return 0 == key.compare(depth, prefix.size(), prefix);
+        }
+
+        static Leaf* NewLeaf(std::string_view key, T&& value) {
+            auto* leaf = new Leaf;
+            leaf->type = NodeType::kLeaf;
+            leaf->key.assign(key);
+            leaf->value = std::move(value);
+            return leaf;
+        }
+
+        static Node4* NewNode4(std::string_view prefix) {
+            auto* node = new Node4;
+            node->type = NodeType::kNode4;
+            node->prefix.assign(prefix);
+            return node;
+        }
+
+        static void FreeNode(Node* node) {
+            if (!node) return;
+            switch (node->type) {
+                case NodeType::kLeaf:
+                    delete static_cast<Leaf*>(node);
+                    return;
+                case NodeType::kNode4: {
+                    auto* n = static_cast<Node4*>(node);
+                    for (std::uint16_t i = 0; i < n->childNum; ++i) FreeNode(n->children[i]);
+                    delete n->terminal;
+                    delete n;
+                    return;
+                }
+                case NodeType::kNode16: {
+                    auto* n = static_cast<Node16*>(node);
+                    for (std::uint16_t i = 0; i < n->childNum; ++i) FreeNode(n->children[i]);
+                    delete n->terminal;
+                    delete n;
+                    return;
+                }
+                case NodeType::kNode48: {
+                    auto* n = static_cast<Node48*>(node);
+                    for (std::uint16_t i = 0; i < n->childNum; ++i) FreeNode(n->children[i]);
+                    delete n->terminal;
+                    delete n;
+                    return;
+                }
+                case NodeType::kNode256: {
+                    auto* n = static_cast<Node256*>(node);
+                    for (auto* child: n->children) FreeNode(child);
+                    delete n->terminal;
+                    delete n;
+                    return;
+                }
+            }
+        }
+
+        // Node16内查找与byte相等的槽位，未找到返回-1
+        static int Node16Find(const Node16* node, std::uint8_t byte) {
+#ifdef FOXBATDB_ART_USE_SSE2
+            auto cmp = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(node->keys)));
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(cmp)) & ((1u << node->childNum) - 1);
+            return mask ? std::countr_zero(mask) : -1;
+#else
+            for (std::uint16_t i = 0; i < node->childNum; ++i) {
+                if (node->keys[i] == byte) return i;
+            }
+            return -1;
+#endif
+        }
+
+        // Node16内首个大于byte的槽位，即有序插入位置
+        static std::uint16_t Node16UpperBound(const Node16* node, std::uint8_t byte) {
+#ifdef FOXBATDB_ART_USE_SSE2
+            // SSE2仅有有符号比较，异或0x80将无符号序映射为有符号序
+            auto bias = _mm_set1_epi8(static_cast<char>(0x80));
+            auto target = _mm_xor_si128(_mm_set1_epi8(static_cast<char>(byte)), bias);
+            auto keys = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(node->keys)), bias);
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmplt_epi8(target, keys))) & ((1u << node->childNum) - 1);
+            return mask ? static_cast<std::uint16_t>(std::countr_zero(mask)) : node->childNum;
+#else
+            std::uint16_t i = 0;
+            while ((i < node->childNum) && (node->keys[i] <= byte)) ++i;
+            return i;
+#endif
+        }
+
+        static Node** FindChild(InnerNode* node, std::uint8_t byte) {
+            switch (node->type) {
+                case NodeType::kNode4: {
+                    auto* n = static_cast<Node4*>(node);
+                    for (std::uint16_t i = 0; i < n->childNum; ++i) {
+                        if (n->keys[i] == byte) return &n->children[i];
+                    }
+                    return nullptr;
+                }
+                case NodeType::kNode16: {
+                    auto* n = static_cast<Node16*>(node);
+                    auto i = Node16Find(n, byte);
+                    return (i < 0) ? nullptr : &n->children[i];
+                }
+                case NodeType::kNode48: {
+                    auto* n = static_cast<Node48*>(node);
+                    auto idx = n->childIndex[byte];
+                    return (Node48::EMPTY == idx) ? nullptr : &n->children[idx - 1];
+                }
+                case NodeType::kNode256: {
+                    auto* n = static_cast<Node256*>(node);
+                    return n->children[byte] ? &n->children[byte] : nullptr;
+                }
+                default:
+                    return nullptr;
+            }
+        }
+
+        static void CopyHeader(InnerNode* dst, InnerNode* src) {
+            dst->childNum = src->childNum;
+            dst->terminal = src->terminal;
+            dst->prefix = std::move(src->prefix);
+        }
+
+        // 添加子节点，节点已满时扩容并更新ref
+        static void AddChild(Node*& ref, std::uint8_t byte, Node* child) {
+            switch (ref->type) {
+                case NodeType::kNode4: {
+                    auto* n = static_cast<Node4*>(ref);
+                    if (n->childNum < 4) {
+                        std::uint16_t pos = 0;
+                        while ((pos < n->childNum) && (n->keys[pos] < byte)) ++pos;
+                        std::memmove(n->keys + pos + 1, n->keys + pos, n->childNum - pos);
+                        std::memmove(n->children + pos + 1, n->children + pos, (n->childNum - pos) * sizeof(Node*));
+                        n->keys[pos] = byte;
+                        n->children[pos] = child;
+                        ++n->childNum;
+                        return;
+                    }
+                    auto* grown = new Node16;
+                    grown->type = NodeType::kNode16;
+                    CopyHeader(grown, n);
+                    std::memcpy(grown->keys, n->keys, 4);
+                    std::memcpy(grown->children, n->children, 4 * sizeof(Node*));
+                    delete n;
+                    ref = grown;
+                    AddChild(ref, byte, child);
+                    return;
+                }
+                case NodeType::kNode16: {
+                    auto* n = static_cast<Node16*>(ref);
+                    if (n->childNum < 16) {
+                        auto pos = Node16UpperBound(n, byte);
+                        std::memmove(n->keys + pos + 1, n->keys + pos, n->childNum - pos);
+                        std::memmove(n->children + pos + 1, n->children + pos, (n->childNum - pos) * sizeof(Node*));
+                        n->keys[pos] = byte;
+                        n->children[pos] = child;
+                        ++n->childNum;
+                        return;
+                    }
+                    auto* grown = new Node48;
+                    grown->type = NodeType::kNode48;
+                    CopyHeader(grown, n);
+                    std::memset(grown->childIndex, Node48::EMPTY, sizeof(grown->childIndex));
+                    for (std::uint8_t i = 0; i < 16; ++i) {
+                        grown->children[i] = n->children[i];
+                        grown->childIndex[n->keys[i]] = i + 1;
+                    }
+                    delete n;
+                    ref = grown;
+                    AddChild(ref, byte, child);
+                    return;
+                }
+                case NodeType::kNode48: {
+                    auto* n = static_cast<Node48*>(ref);
+                    if (n->childNum < 48) {
+                        n->children[n->childNum] = child;
+                        n->childIndex[byte] = static_cast<std::uint8_t>(n->childNum + 1);
+                        ++n->childNum;
+                        return;
+                    }
+                    auto* grown = new Node256;
+                    grown->type = NodeType::kNode256;
+                    CopyHeader(grown, n);
+                    std::fill(std::begin(grown->children), std::end(grown->children), nullptr);
+                    for (std::size_t b = 0; b < 256; ++b) {
+                        if (Node48::EMPTY != n->childIndex[b])
+                            grown->children[b] = n->children[n->childIndex[b] - 1];
+                    }
+                    delete n;
+                    ref = grown;
+                    AddChild(ref, byte, child);
+                    return;
+                }
+                case NodeType::kNode256: {
+                    auto* n = static_cast<Node256*>(ref);
+                    n->children[byte] = child;
+                    ++n->childNum;
+                    return;
+                }
+                default:
+                    return;
+            }
+        }
+
+        // 将child挂到新建节点下：key恰好在此结束时作为terminal，否则按下一字节挂为子节点
+        static void AttachToNewNode(Node*& ref, Leaf* leaf, std::size_t depth) {
+            auto* inner = static_cast<InnerNode*>(ref);
+            if (leaf->key.size() == depth)
+                inner->terminal = leaf;
+            else
+                AddChild(ref, static_cast<std::uint8_t>(leaf->key[depth]), leaf);
+        }
+
+        bool Insert(Node*& ref, std::string_view key, std::size_t depth, T&& value) {
+            if (!ref) {
+                ref = NewLeaf(key, std::move(value));
+                return true;
+            }
+
+            if (NodeType::kLeaf == ref->type) {
+                auto* leaf = static_cast<Leaf*>(ref);
+                if (leaf->key == key) {
+                    leaf->value = std::move(value);
+                    return false;
+                }
+
+                // 以两个key的公共部分作为新节点的压缩路径
+                std::size_t lcp = 0;
+                auto maxLcp = std::min(leaf->key.size(), key.size()) - depth;
+                while ((lcp < maxLcp) && (leaf->key[depth + lcp] == key[depth + lcp])) ++lcp;
+
+                Node* node = NewNode4(key.substr(depth, lcp));
+                AttachToNewNode(node, leaf, depth + lcp);
+                AttachToNewNode(node, NewLeaf(key, std::move(value)), depth + lcp);
+                ref = node;
+                return true;
+            }
+
+            auto* inner = static_cast<InnerNode*>(ref);
+            std::size_t mismatch = 0;
+            auto maxMatch = std::min(inner->prefix.size(), key.size() - depth);
+            while ((mismatch < maxMatch) && (inner->prefix[mismatch] == key[depth + mismatch])) ++mismatch;
+
+            if (mismatch < inner->prefix.size()) {
+                // 压缩路径中途分叉，拆分出新的父节点
+                Node* node = NewNode4(std::string_view{inner->prefix}.substr(0, mismatch));
+                auto byte = static_cast<std::uint8_t>(inner->prefix[mismatch]);
+                inner->prefix.erase(0, mismatch + 1);
+                AddChild(node, byte, inner);
+                AttachToNewNode(node, NewLeaf(key, std::move(value)), depth + mismatch);
+                ref = node;
+                return true;
+            }
+
+            depth += inner->prefix.size();
+            if (depth == key.size()) {
+                if (inner->terminal) {
+                    inner->terminal->value = std::move(value);
+                    return false;
+                }
+                inner->terminal = NewLeaf(key, std::move(value));
+                return true;
+            }
+
+            auto byte = static_cast<std::uint8_t>(key[depth]);
+            if (auto** child = FindChild(inner, byte); child)
+                return Insert(*child, key, depth + 1, std::move(value));
+
+            AddChild(ref, byte, NewLeaf(key, std::move(value)));
+            return true;
+        }
+
+        static void RemoveChild(Node*& ref, std::uint8_t byte) {
+            switch (ref->type) {
+                case NodeType::kNode4: {
+                    auto* n = static_cast<Node4*>(ref);
+                    std::uint16_t pos = 0;
+                    while (n->keys[pos] != byte) ++pos;
+                    std::memmove(n->keys + pos, n->keys + pos + 1, n->childNum - pos - 1);
+                    std::memmove(n->children + pos, n->children + pos + 1, (n->childNum - pos - 1) * sizeof(Node*));
+                    --n->childNum;
+                    return;
+                }
+                case NodeType::kNode16: {
+                    auto* n = static_cast<Node16*>(ref);
+                    auto pos = static_cast<std::uint16_t>(Node16Find(n, byte));
+                    std::memmove(n->keys + pos, n->keys + pos + 1, n->childNum - pos - 1);
+                    std::memmove(n->children + pos, n->children + pos + 1, (n->childNum - pos - 1) * sizeof(Node*));
+                    --n->childNum;
+                    return;
+                }
+                case NodeType::kNode48: {
+                    auto* n = static_cast<Node48*>(ref);
+                    auto idx = n->childIndex[byte] - 1;
+                    n->childIndex[byte] = Node48::EMPTY;
+                    // 用末尾子节点填补空位，保持children紧凑
+                    auto last = n->childNum - 1;
+                    if (idx != last) {
+                        n->children[idx] = n->children[last];
+                        for (auto& ci: n->childIndex) {
+                            if (ci == last + 1) {
+                                ci = static_cast<std::uint8_t>(idx + 1);
+                                break;
+                            }
+                        }
+                    }
+                    --n->childNum;
+                    return;
+                }
+                case NodeType::kNode256: {
+                    auto* n = static_cast<Node256*>(ref);
+                    n->children[byte] = nullptr;
+                    --n->childNum;
+                    return;
+                }
+                default:
+                    return;
+            }
+        }
+
+        // 删除后收缩节点：子节点过少时降级，仅剩单一分支时与子节点合并路径
+        static void Shrink(Node*& ref) {
+            auto* inner = static_cast<InnerNode*>(ref);
+            switch (ref->type) {
+                case NodeType::kNode4: {
+                    auto* n = static_cast<Node4*>(ref);
+                    if (0 == n->childNum) {
+                        ref = n->terminal;// 可能为nullptr
+                        delete n;
+                    } else if ((1 == n->childNum) && !n->terminal) {
+                        auto* child = n->children[0];
+                        if (NodeType::kLeaf != child->type) {
+                            auto* childInner = static_cast<InnerNode*>(child);
+                            childInner->prefix = n->prefix + static_cast<char>(n->keys[0]) + childInner->prefix;
+                        }
+                        ref = child;
+                        delete n;
+                    }
+                    return;
+                }
+                case NodeType::kNode16: {
+                    auto* n = static_cast<Node16*>(ref);
+                    if (n->childNum > 3) return;
+                    auto* shrunk = new Node4;
+                    shrunk->type = NodeType::kNode4;
+                    CopyHeader(shrunk, inner);
+                    std::memcpy(shrunk->keys, n->keys, n->childNum);
+                    std::memcpy(shrunk->children, n->children, n->childNum * sizeof(Node*));
+                    delete n;
+                    ref = shrunk;
+                    Shrink(ref);
+                    return;
+                }
+                case NodeType::kNode48: {
+                    auto* n = static_cast<Node48*>(ref);
+                    if (n->childNum > 12) return;
+                    auto* shrunk = new Node16;
+                    shrunk->type = NodeType::kNode16;
+                    CopyHeader(shrunk, inner);
+                    std::uint16_t pos = 0;
+                    for (std::size_t b = 0; b < 256; ++b) {
+                        if (Node48::EMPTY == n->childIndex[b]) continue;
+                        shrunk->keys[pos] = static_cast<std::uint8_t>(b);
+                        shrunk->children[pos] = n->children[n->childIndex[b] - 1];
+                        ++pos;
+                    }
+                    delete n;
+                    ref = shrunk;
+                    return;
+                }
+                case NodeType::kNode256: {
+                    auto* n = static_cast<Node256*>(ref);
+                    if (n->childNum > 37) return;
+                    auto* shrunk = new Node48;
+                    shrunk->type = NodeType::kNode48;
+                    CopyHeader(shrunk, inner);
+                    std::memset(shrunk->childIndex, Node48::EMPTY, sizeof(shrunk->childIndex));
+                    std::uint8_t pos = 0;
+                    for (std::size_t b = 0; b < 256; ++b) {
+                        if (!n->children[b]) continue;
+                        shrunk->children[pos] = n->children[b];
+                        shrunk->childIndex[b] = ++pos;
+                    }
+                    delete n;
+                    ref = shrunk;
+                    return;
+                }
+                default:
+                    return;
+            }
+        }
+
+        bool Erase(Node*& ref, std::string_view key, std::size_t depth) {
+            if (!ref) return false;
+
+            if (NodeType::kLeaf == ref->type) {
+                auto* leaf = static_cast<Leaf*>(ref);
+                if (leaf->key != key) return false;
+                delete leaf;
+                ref = nullptr;
+                return true;
+            }
+
+            auto* inner = static_cast<InnerNode*>(ref);
+            if (!MatchPrefix(inner->prefix, key, depth))
+                return false;
+            depth += inner->prefix.size();
+
+            if (depth == key.size()) {
+                if (!inner->terminal) return false;
+                delete inner->terminal;
+                inner->terminal = nullptr;
+                Shrink(ref);
+                return true;
+            }
+
+            auto byte = static_cast<std::uint8_t>(key[depth]);
+            auto** child = FindChild(inner, byte);
+            if (!child || !Erase(*child, key, depth + 1))
+                return false;
+
+            if (!*child) {
+                RemoveChild(ref, byte);
+                Shrink(ref);
+            }
+            return true;
+        }
+
+        // 按字节顺序访问内部节点的子节点
+        template<typename F>
+        static bool ForEachChild(const InnerNode* node, bool reverse, F&& f) {
+            switch (node->type) {
+                case NodeType::kNode4: {
+                    auto* n = static_cast<const Node4*>(node);
+                    for (std::uint16_t i = 0; i < n->childNum; ++i) {
+                        auto idx = reverse ? (n->childNum - 1 - i) : i;
+                        if (!f(n->keys[idx], n->children[idx])) return false;
+                    }
+                    return true;
+                }
+                case NodeType::kNode16: {
+                    auto* n = static_cast<const Node16*>(node);
+                    for (std::uint16_t i = 0; i < n->childNum; ++i) {
+                        auto idx = reverse ? (n->childNum - 1 - i) : i;
+                        if (!f(n->keys[idx], n->children[idx])) return false;
+                    }
+                    return true;
+                }
+                case NodeType::kNode48: {
+                    auto* n = static_cast<const Node48*>(node);
+                    for (std::size_t i = 0; i < 256; ++i) {
+                        auto b = reverse ? (255 - i) : i;
+                        if (Node48::EMPTY == n->childIndex[b]) continue;
+                        if (!f(static_cast<std::uint8_t>(b), n->children[n->childIndex[b] - 1])) return false;
+                    }
+                    return true;
+                }
+                case NodeType::kNode256: {
+                    auto* n = static_cast<const Node256*>(node);
+                    for (std::size_t i = 0; i < 256; ++i) {
+                        auto b = reverse ? (255 - i) : i;
+                        if (!n->children[b]) continue;
+                        if (!f(static_cast<std::uint8_t>(b), n->children[b])) return false;
+                    }
+                    return true;
+                }
+                default:
+                    return true;
+            }
+        }
+
+        // path为当前子树所有key的公共前缀，借此剪除整棵落在区间外的子树；返回false表示终止遍历
+        template<typename Visitor>
+        static bool VisitRange(const Node* node, std::string& path, const std::string* lo, const std::string* hi,
+                               bool reverse, Visitor& visitor) {
+            if (!node) return true;
+
+            if (NodeType::kLeaf == node->type) {
+                auto* leaf = static_cast<const Leaf*>(node);
+                if ((lo && (leaf->key < *lo)) || (hi && (leaf->key > *hi)))
+                    return true;
+                return visitor(leaf->key, leaf->value);
+            }
+
+            auto* inner = static_cast<const InnerNode*>(node);
+            auto pathSize = path.size();
+            path += inner->prefix;
+
+            bool ret = true;
+            if ((lo && (lo->compare(0, path.size(), path) > 0)) ||
+                (hi && (hi->compare(0, path.size(), path) < 0))) {
+                path.resize(pathSize);
+                return true;
+            }
+
+            auto visitTerminal = [&]() {
+                if (inner->terminal)
+                    return VisitRange(inner->terminal, path, lo, hi, reverse, visitor);
+                return true;
+            };
+
+            if (!reverse) ret = visitTerminal();
+            if (ret) {
+                ret = ForEachChild(inner, reverse, [&](std::uint8_t byte, const Node* child) {
+                    path.push_back(static_cast<char>(byte));
+                    bool cont = VisitRange(child, path, lo, hi, reverse, visitor);
+                    path.pop_back();
+                    return cont;
+                });
+            }
+            if (ret && reverse) ret = visitTerminal();
+
+            path.resize(pathSize);
+            return ret;
+        }
+    };
+}// namespace foxbatdb
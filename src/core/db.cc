@@ -5,31 +5,39 @@
 #include "frontend/server.h"
 #include "log/serverlog.h"
 #include "memory.h"
+#include "tracking.h"
 #include "utils/utils.h"
 #include <algorithm>
 #include <filesystem>
+#include <limits>
 
 namespace foxbatdb {
-    DatabaseManager::DatabaseManager()
-        : mIsNonWrite_{false}, mMaxMemoryStrategy_{nullptr} {
-        switch (Flags::GetInstance().maxMemoryPolicy) {
-            case MaxMemoryPolicyEnum::eLRU:
-                mMaxMemoryStrategy_ = new LRUStrategy();
-                break;
-            case MaxMemoryPolicyEnum::eNoeviction:
-            default:
-                mMaxMemoryStrategy_ = new NoevictionStrategy();
-                break;
+    namespace {
+        // ʱΪһľʱ䲻ósteady_clockʱıʾΧ
+        std::optional<std::chrono::milliseconds> ToExpireDuration(std::int64_t val, std::int64_t msPerUnit) {
+            if ((val <= 0) || (val > std::numeric_limits<std::int64_t>::max() / msPerUnit))
+                return std::nullopt;
+
+            auto ms = std::chrono::milliseconds{val * msPerUnit};
+            auto steadyLeft = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::time_point::max() - std::chrono::steady_clock::now());
+            auto timestampLeft = std::numeric_limits<std::int64_t>::max() -
+                                 static_cast<std::int64_t>(utils::GetMillisecondTimestamp());
+            if ((ms >= steadyLeft) || (ms.count() >= timestampLeft))
+                return std::nullopt;
+            return ms;
         }
+    }// namespace
 
+    DatabaseManager::DatabaseManager()
+        : mIsNonWrite_{false}, mNextExpireDBIdx_{0} {
+        // ÿDBά̭״̬ⲻͬDBͬkey໥
         for (std::uint8_t i = 0; i < Flags::GetInstance().dbMaxNum; ++i) {
-            mDBList_.emplace_back(new Database(i, mMaxMemoryStrategy_));
+            mDBList_.emplace_back(new Database(i, CreateMaxMemoryStrategy()));
         }
     }
 
     DatabaseManager::~DatabaseManager() {
-        delete mMaxMemoryStrategy_;
-
         for (Database* db: mDBList_)
             delete db;
     }
@@ -46,13 +54,16 @@ namespace foxbatdb {
                            [](const Database* db) -> bool { return db->HaveMemoryAvailable(); });
     }
 
-    void DatabaseManager::ScanDBForReleaseMemory() {
+    bool DatabaseManager::ScanDBForReleaseMemory() {
+        bool released = false;
         for (auto* db: mDBList_) {
-            if (db->HaveMemoryAvailable()) {
-                db->ReleaseMemory();
-                CancelNonWrite();
-            }
+            if (db->HaveMemoryAvailable() && db->ReleaseMemory())
+                released = true;
         }
+        // ûkeyɾʱάֻ״̬
+        if (released)
+            CancelNonWrite();
+        return released;
     }
 
     void DatabaseManager::SetNonWrite() { mIsNonWrite_ = true; }
@@ -80,13 +91,78 @@ namespace foxbatdb {
         }
     }
 
-    Database::Database(std::uint8_t dbIdx, MaxMemoryStrategy* maxMemoryStrategy)
+    bool DatabaseManager::LoadKeySegments(DataLogFile* dataFile) {
+        if (!KeySegment::ValidateManifest(std::filesystem::file_size(dataFile->Name()), mDBList_.size()))
+            return false;
+        for (auto* db: mDBList_) {
+            if (!db->LoadKeySegment(dataFile)) {
+                // һȫ˻ȫط
+                for (auto* loaded: mDBList_)
+                    loaded->LoadKeySegment(nullptr);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void DatabaseManager::CommitKeySegments(std::uint64_t dataFileSize) {
+        bool allCommitted = true;
+        for (auto* db: mDBList_)
+            allCommitted = db->CommitKeySegment() && allCommitted;
+        if (allCommitted)
+            KeySegment::WriteManifest(dataFileSize, mDBList_.size());
+    }
+
+    void DatabaseManager::ActiveExpireCycle() {
+        if (mDBList_.empty()) return;
+
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::microseconds{Flags::GetInstance().activeExpireCycleBudgetUs};
+        std::size_t expiredKeyNum = 0;
+        for (std::size_t i = 0; i < mDBList_.size(); ++i) {
+            auto idx = (mNextExpireDBIdx_ + i) % mDBList_.size();
+            expiredKeyNum += mDBList_[idx]->ActiveExpire(deadline);
+            if (std::chrono::steady_clock::now() >= deadline) {
+                // ʱԤľ¸ڴһDBʼǶDB
+                mNextExpireDBIdx_ = (idx + 1) % mDBList_.size();
+                break;
+            }
+        }
+        UpdateActiveExpireStats(expiredKeyNum);
+    }
+
+    void DatabaseManager::UpdateActiveExpireStats(std::size_t expiredKeyNum) {
+        mExpireStats_.totalExpiredKeys += expiredKeyNum;
+        mExpireStats_.windowExpiredKeys += expiredKeyNum;
+
+        auto now = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::duration<double>(now - mExpireStats_.windowStartTime);
+        if (elapsed < std::chrono::seconds{1}) return;
+
+        if (mExpireStats_.windowExpiredKeys) {
+            ServerLog::GetInstance().Info("active expire: {:.1f} keys/sec, {} keys expired in total",
+                                          static_cast<double>(mExpireStats_.windowExpiredKeys) / elapsed.count(),
+                                          mExpireStats_.totalExpiredKeys);
+        }
+        mExpireStats_.windowExpiredKeys = 0;
+        mExpireStats_.windowStartTime = now;
+    }
+
+    Database::Database(std::uint8_t dbIdx, std::unique_ptr<MaxMemoryStrategy> maxMemoryStrategy)
         : mDBIdx_{dbIdx},
           mIndex_{dbIdx},
-          mMaxMemoryStrategy_{maxMemoryStrategy} { assert(nullptr != mMaxMemoryStrategy_); }
+          mMaxMemoryStrategy_{std::move(maxMemoryStrategy)},
+          mExpireWheel_{std::chrono::milliseconds{Flags::GetInstance().activeExpireCronJobPeriodMs}} {
+        assert(nullptr != mMaxMemoryStrategy_);
+        mIndex_.SetExpiredKeyHandler([this](const std::string& key) { OnKeyExpired(key); });
+    }
 
-    void Database::ReleaseMemory() {
-        mMaxMemoryStrategy_->ReleaseKey(&mIndex_);
+    bool Database::ReleaseMemory() {
+        // ̭DELһ֪ͨwatchͻ˻٣еkeyѱɾֱȷʵɾһ
+        while (auto key = mMaxMemoryStrategy_->EvictKey()) {
+            if (!Del(*key)) return true;
+        }
+        return false;
     }
 
     bool Database::HaveMemoryAvailable() const {
@@ -111,6 +187,11 @@ namespace foxbatdb {
 
         snapshot->DumpToDisk(key, snapshot->GetValue());
         mIndex_.Put(key, snapshot);
+        mMaxMemoryStrategy_->UpdateStateForWriteOp(key, *snapshot);
+        if (snapshot->HasExpiration())
+            mExpireWheel_.Add(key, snapshot->GetExpirationTimePoint());
+        NotifyWatchedClientSession(key);
+        ClientTracking::GetInstance().Invalidate(key);
     }
 
     void Database::InsertTxFlag(RecordState txFlag, std::size_t txCmdNum) {
@@ -118,9 +199,12 @@ namespace foxbatdb {
     }
 
     void Database::NotifyWatchedClientSession(const std::string& key) {
+        auto internedKey = InternedKey::Find(key);// δκνṹõkeyܱwatch
+        if (internedKey.Empty()) return;
+
         std::unique_lock l{mt_};
-        if (mWatchedMap_.contains(key)) {
-            for (const auto& weak: mWatchedMap_.at(key)) {
+        if (auto it = mWatchedMap_.find(internedKey); it != mWatchedMap_.end()) {
+            for (const auto& weak: it->second) {
                 if (auto clt = weak.lock(); clt) {
                     clt->SetCurrentTxToFail();
                 }
@@ -128,21 +212,49 @@ namespace foxbatdb {
         }
     }
 
+    void Database::OnKeyExpired(const std::string& key) {
+        mMaxMemoryStrategy_->UpdateStateForDelOp(key);
+        NotifyWatchedClientSession(key);
+        ClientTracking::GetInstance().Invalidate(key);
+    }
+
     void Database::LoadHistoryData(DataLogFile* file, std::streampos pos,
                                    const DataLogFile::Data& record) {
+        // ɾѹڵļ¼ʹ֮ǰصͬkeyʧЧ
+        if (record.value.empty() ||
+            (record.expireAtMs && (record.expireAtMs <= utils::GetMillisecondTimestamp()))) {
+            mIndex_.DelHistoryData(record.key);
+            return;
+        }
+
         MemoryIndex::HistoryDataInfo opt{
                 .logFilePtr = file,
                 .pos = pos,
-                .microSecondTimestamp = record.timestamp};
-        auto ec = mIndex_.PutHistoryData(record.key, opt);
+                .microSecondTimestamp = record.timestamp,
+                .expireAtMs = record.expireAtMs};
+        LoadHistoryIndex(record.key, opt);
+    }
+
+    void Database::LoadHistoryIndex(const std::string& key, const MemoryIndex::HistoryDataInfo& info) {
+        // GetңָkeyΪʹãӰ̭˳keyѡ
+        auto [ec, valObj] = mIndex_.PutHistoryData(key, info);
         if (ec) {
-            ServerLog::GetInstance().Warning("load history data failed: []", ec.message());
+            ServerLog::GetInstance().Warning("load history data failed: {}", ec.message());
+            return;
         }
+
+        mMaxMemoryStrategy_->UpdateStateForWriteOp(key, *valObj);
+        if (valObj->HasExpiration())
+            mExpireWheel_.Add(key, valObj->GetExpirationTimePoint());
+    }
+
+    MemoryIndex::RecordList Database::IndexSnapshot() const {
+        return mIndex_.Snapshot();
     }
 
     std::tuple<std::error_code, std::optional<std::string>> Database::StrSet(
-            const std::string& key, const std::string& val,
-            const std::vector<CommandOption>& opts) {
+            const std::string& key, std::string_view val,
+            const std::pmr::vector<CommandOption>& opts) {
         std::error_code ec;
         if ((key.size() > Flags::GetInstance().keyMaxBytes) ||
             (val.size() > Flags::GetInstance().valMaxBytes)) {
@@ -172,8 +284,11 @@ namespace foxbatdb {
         valObj->DumpToDisk(key, val);
         mIndex_.Put(key, valObj);
 
-        mMaxMemoryStrategy_->UpdateStateForWriteOp(key);
+        mMaxMemoryStrategy_->UpdateStateForWriteOp(key, *valObj);
+        if (valObj->HasExpiration())
+            mExpireWheel_.Add(key, valObj->GetExpirationTimePoint());
         NotifyWatchedClientSession(key);
+        ClientTracking::GetInstance().Invalidate(key);
         return std::make_tuple(error::ProtocolErrorCode::kSuccess, data);
     }
 
@@ -187,16 +302,20 @@ namespace foxbatdb {
                 auto sec = utils::ToNumber<std::int64_t>(opt.argv.front());
                 if (!sec.has_value()) {
                     err = error::ProtocolErrorCode::kSyntax;
+                } else if (auto ms = ToExpireDuration(*sec, 1000); !ms.has_value()) {
+                    err = error::RuntimeErrorCode::kInvalidExpireTime;
                 } else {
-                    obj.SetExpiration(std::chrono::seconds{*sec});
+                    obj.SetExpiration(*ms);
                 }
             } break;
             case CmdOptionType::kPX: {
-                auto ms = utils::ToNumber<std::int64_t>(opt.argv.front());
-                if (!ms.has_value()) {
+                auto val = utils::ToNumber<std::int64_t>(opt.argv.front());
+                if (!val.has_value()) {
                     err = error::ProtocolErrorCode::kSyntax;
+                } else if (auto ms = ToExpireDuration(*val, 1); !ms.has_value()) {
+                    err = error::RuntimeErrorCode::kInvalidExpireTime;
                 } else {
-                    obj.SetExpiration(std::chrono::milliseconds{*ms});
+                    obj.SetExpiration(*ms);
                 }
             } break;
             case CmdOptionType::kNX:
@@ -214,7 +333,7 @@ namespace foxbatdb {
                 if (mIndex_.Contains(key)) {
                     auto oldObj = mIndex_.Get(key);
                     if (!oldObj.expired())
-                        obj.SetExpiration(oldObj.lock()->GetExpiration());
+                        obj.SetExpirationTimePoint(oldObj.lock()->GetExpirationTimePoint());
                 }
                 break;
             case CmdOptionType::kGET:
@@ -243,8 +362,19 @@ namespace foxbatdb {
         return val;
     }
 
+    std::vector<std::optional<std::string>> Database::StrMultiGet(const std::vector<std::string>& keys) {
+        auto values = mIndex_.MultiGet(keys);
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (values[i].has_value())
+                mMaxMemoryStrategy_->UpdateStateForReadOp(keys[i]);
+        }
+        return values;
+    }
+
     std::error_code Database::Del(const std::string& key) {
         NotifyWatchedClientSession(key);
+        ClientTracking::GetInstance().Invalidate(key);
+        mMaxMemoryStrategy_->UpdateStateForDelOp(key);
         return mIndex_.Del(key);
     }
 
@@ -261,27 +391,137 @@ namespace foxbatdb {
             return;
         cltPtr->AddWatchKey(key);
 
+        InternedKey internedKey{key};
         std::unique_lock l{mt_};
-        mWatchedMap_[key].emplace_back(clt);
+        mWatchedMap_[std::move(internedKey)].emplace_back(clt);
     }
 
     void Database::DelWatchKeyAndClient(const std::string& key) {
         if (!mIndex_.Contains(key))
             return;
 
+        auto internedKey = InternedKey::Find(key);
+        if (internedKey.Empty()) return;
+
         std::unique_lock l{mt_};
-        mWatchedMap_.erase(key);
+        mWatchedMap_.erase(internedKey);
     }
 
-    std::vector<std::pair<std::string, std::string>> Database::PrefixSearch(const std::string& prefix) const {
+    std::tuple<std::error_code, std::vector<std::pair<std::string, std::string>>> Database::PrefixSearch(
+            const std::string& prefix) const {
+        if (!mIndex_.SupportPrefix())
+            return {error::RuntimeErrorCode::kIndexNotSupport, {}};
+
         auto list = mIndex_.PrefixSearch(prefix);
         for (const auto& [key, _]: list)
             mMaxMemoryStrategy_->UpdateStateForReadOp(key);
-        return list;
+        return {error::RuntimeErrorCode::kSuccess, std::move(list)};
+    }
+
+    std::tuple<std::error_code, std::vector<std::string>> Database::PrefixKeys(
+            const std::string& prefix, std::size_t limit) const {
+        if (!mIndex_.SupportPrefix())
+            return {error::RuntimeErrorCode::kIndexNotSupport, {}};
+        return {error::RuntimeErrorCode::kSuccess, mIndex_.PrefixKeys(prefix, limit)};
+    }
+
+    std::tuple<std::error_code, std::size_t> Database::PrefixCount(const std::string& prefix) const {
+        if (!mIndex_.SupportPrefix())
+            return {error::RuntimeErrorCode::kIndexNotSupport, 0};
+        return {error::RuntimeErrorCode::kSuccess, mIndex_.PrefixCount(prefix)};
+    }
+
+    std::tuple<std::error_code, std::vector<std::pair<std::string, std::string>>> Database::RangeSearch(
+            const std::string& start, const std::string& end, std::size_t limit, bool reverse) const {
+        if (!mIndex_.IsOrdered())
+            return {error::RuntimeErrorCode::kIndexNotSupport, {}};
+
+        auto list = mIndex_.RangeSearch(start, end, limit, reverse);
+        for (const auto& [key, _]: list)
+            mMaxMemoryStrategy_->UpdateStateForReadOp(key);
+        return {error::RuntimeErrorCode::kSuccess, std::move(list)};
+    }
+
+    std::tuple<std::error_code, std::uint64_t> Database::Scan(const std::string& pattern, std::uint64_t cursor,
+                                                              std::size_t count, std::vector<std::string>& keys) const {
+        // ģʽ׸֮ͨǰĲΪǰ׺СHAT-trieıΧϣֻȫ
+        std::string prefix;
+        if (mIndex_.SupportPrefix())
+            prefix = pattern.substr(0, pattern.find_first_of("*?[\\"));
+
+        MemoryIndex::RecordList records;
+        auto [ec, nextCursor] = mIndex_.Scan(prefix, cursor, count, records);
+        if (ec) return {ec, 0};
+
+        for (auto& [key, _]: records) {
+            if (utils::GlobMatch(pattern, key))
+                keys.emplace_back(std::move(key));
+        }
+        return {error::RuntimeErrorCode::kSuccess, nextCursor};
+    }
+
+    std::tuple<std::error_code, std::uint64_t> Database::PrefixScan(
+            const std::string& prefix, std::uint64_t cursor, std::size_t count,
+            std::vector<std::pair<std::string, std::string>>& kvList) const {
+        if (!mIndex_.SupportPrefix())
+            return {error::RuntimeErrorCode::kIndexNotSupport, 0};
+
+        MemoryIndex::RecordList records;
+        auto [ec, nextCursor] = mIndex_.Scan(prefix, cursor, count, records);
+        if (ec) return {ec, 0};
+
+        std::vector<std::shared_ptr<RecordObject>> objs;
+        objs.reserve(records.size());
+        for (const auto& [_, valObj]: records)
+            objs.emplace_back(valObj);
+        auto values = RecordObject::BatchGetValue(objs);
+
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            if (values[i].empty()) continue;
+            mMaxMemoryStrategy_->UpdateStateForReadOp(records[i].first);
+            kvList.emplace_back(std::move(records[i].first), std::move(values[i]));
+        }
+        return {error::RuntimeErrorCode::kSuccess, nextCursor};
     }
 
     void Database::Merge(DataLogFile* targetFile, const DataLogFile* writableFile) {
-        mIndex_.Merge(targetFile, writableFile);
+        for (const auto& key: mIndex_.Merge(targetFile, writableFile))
+            OnKeyExpired(key);
+    }
+
+    bool Database::LoadKeySegment(DataLogFile* dataFile) {
+        return mIndex_.LoadKeySegment(dataFile);
+    }
+
+    bool Database::CommitKeySegment() {
+        return mIndex_.CommitKeySegment();
+    }
+
+    std::size_t Database::ActiveExpire(std::chrono::steady_clock::time_point deadline) {
+        static constexpr std::size_t ACTIVE_EXPIRE_BATCH_SIZE = 64;
+
+        mExpireWheel_.Advance(std::chrono::steady_clock::now(), mExpireCandidates_);
+
+        std::size_t expiredKeyNum = 0;
+        std::vector<std::string> batch;
+        batch.reserve(ACTIVE_EXPIRE_BATCH_SIZE);
+        while (!mExpireCandidates_.empty()) {
+            batch.clear();
+            while (!mExpireCandidates_.empty() && (batch.size() < ACTIVE_EXPIRE_BATCH_SIZE)) {
+                batch.emplace_back(mExpireCandidates_.front().ToString());
+                mExpireCandidates_.pop_front();
+            }
+
+            auto expiredKeys = mIndex_.DelExpiredKeys(batch);
+            for (const auto& key: expiredKeys)
+                OnKeyExpired(key);
+            expiredKeyNum += expiredKeys.size();
+
+            // δĺѡkey¸
+            if (std::chrono::steady_clock::now() >= deadline)
+                break;
+        }
+        return expiredKeyNum;
     }
 
     std::string Database::StrGetRange(const std::string& key, std::int64_t start, std::int64_t end) {
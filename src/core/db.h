@@ -1,8 +1,12 @@
 #pragma once
 #include "engine.h"
+#include "expire.h"
 #include "frontend/cmdmap.h"
 #include "pubsub.h"
+#include <chrono>
 #include <cstddef>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <tuple>
@@ -14,10 +18,19 @@ namespace foxbatdb {
 
     class DatabaseManager {
     private:
+        struct ActiveExpireStats {
+            std::uint64_t totalExpiredKeys = 0;
+            std::uint64_t windowExpiredKeys = 0;
+            std::chrono::steady_clock::time_point windowStartTime = std::chrono::steady_clock::now();
+        };
+
         bool mIsNonWrite_;
-        MaxMemoryStrategy* mMaxMemoryStrategy_;
         std::vector<Database*> mDBList_;
         PubSubWithChannel mPubSubChannel_;
+        std::size_t mNextExpireDBIdx_;
+        ActiveExpireStats mExpireStats_;
+
+        void UpdateActiveExpireStats(std::size_t expiredKeyNum);
 
         DatabaseManager();
 
@@ -28,7 +41,7 @@ namespace foxbatdb {
         static DatabaseManager& GetInstance();
         void Init();
         bool HaveMemoryAvailable() const;
-        void ScanDBForReleaseMemory();
+        bool ScanDBForReleaseMemory();// 返回是否确实删除了key
         void SetNonWrite();
         void CancelNonWrite();
         bool IsInReadonlyMode() const;
@@ -42,31 +55,40 @@ namespace foxbatdb {
                                         const std::string& msg);
 
         void Merge(DataLogFile* targetFile, const DataLogFile* writableFile);
+        // 磁盘索引模式：重启时加载与首个数据文件匹配的索引段，合并完成后提交新生成的索引段
+        bool LoadKeySegments(DataLogFile* dataFile);
+        void CommitKeySegments(std::uint64_t dataFileSize);
+        void ActiveExpireCycle();
     };
 
     class Database {
     private:
         std::uint8_t mDBIdx_;
         MemoryIndex mIndex_;
-        MaxMemoryStrategy* mMaxMemoryStrategy_;
+        std::unique_ptr<MaxMemoryStrategy> mMaxMemoryStrategy_;
 
         mutable std::mutex mt_;
-        std::unordered_map<std::string, std::vector<std::weak_ptr<CMDSession>>> mWatchedMap_;
+        std::unordered_map<InternedKey, std::vector<std::weak_ptr<CMDSession>>, InternedKey::Hash> mWatchedMap_;
+
+        TimingWheel mExpireWheel_;
+        std::deque<InternedKey> mExpireCandidates_;// 仅由定时任务线程访问
 
         std::tuple<std::error_code, std::optional<std::string>> StrSetWithOption(
                 const std::string& key, RecordObject& obj, const CommandOption& opt);
 
         void NotifyWatchedClientSession(const std::string& key);
+        // 过期key被删除后，与DEL一样同步淘汰策略并通知watch与客户端缓存跟踪
+        void OnKeyExpired(const std::string& key);
 
     public:
-        Database(std::uint8_t dbIdx, MaxMemoryStrategy* maxMemoryStrategy);
+        Database(std::uint8_t dbIdx, std::unique_ptr<MaxMemoryStrategy> maxMemoryStrategy);
         Database(const Database&) = delete;
         Database& operator=(const Database&) = delete;
         Database(Database&&) noexcept = default;
         Database& operator=(Database&&) noexcept = default;
         ~Database() = default;
 
-        void ReleaseMemory();
+        bool ReleaseMemory();// 返回是否确实删除了key
         bool HaveMemoryAvailable() const;
 
         std::shared_ptr<RecordObject> GetRecordSnapshot(const std::string& key);
@@ -76,21 +98,37 @@ namespace foxbatdb {
 
         void LoadHistoryData(DataLogFile* file, std::streampos pos,
                              const DataLogFile::Data& record);
+        void LoadHistoryIndex(const std::string& key, const MemoryIndex::HistoryDataInfo& info);
+        MemoryIndex::RecordList IndexSnapshot() const;
 
         std::tuple<std::error_code, std::optional<std::string>> StrSet(
-                const std::string& key, const std::string& val,
-                const std::vector<CommandOption>& opts = {});
+                const std::string& key, std::string_view val,
+                const std::pmr::vector<CommandOption>& opts = {});
 
         std::optional<std::string> StrGet(const std::string& key);
+        std::vector<std::optional<std::string>> StrMultiGet(const std::vector<std::string>& keys);
         std::error_code Del(const std::string& key);
         std::weak_ptr<RecordObject> Get(const std::string& key);
 
         void AddWatchKeyWithClient(const std::string& key, std::weak_ptr<CMDSession> clt);
         void DelWatchKeyAndClient(const std::string& key);
 
-        std::vector<std::pair<std::string, std::string>> PrefixSearch(const std::string& prefix) const;
+        std::tuple<std::error_code, std::vector<std::pair<std::string, std::string>>> PrefixSearch(
+                const std::string& prefix) const;
+        std::tuple<std::error_code, std::uint64_t> Scan(const std::string& pattern, std::uint64_t cursor,
+                                                         std::size_t count, std::vector<std::string>& keys) const;
+        std::tuple<std::error_code, std::vector<std::string>> PrefixKeys(const std::string& prefix, std::size_t limit) const;
+        std::tuple<std::error_code, std::size_t> PrefixCount(const std::string& prefix) const;
+        std::tuple<std::error_code, std::vector<std::pair<std::string, std::string>>> RangeSearch(
+                const std::string& start, const std::string& end, std::size_t limit, bool reverse) const;
+        std::tuple<std::error_code, std::uint64_t> PrefixScan(
+                const std::string& prefix, std::uint64_t cursor, std::size_t count,
+                std::vector<std::pair<std::string, std::string>>& kvList) const;
 
         void Merge(DataLogFile* targetFile, const DataLogFile* writableFile);
+        bool LoadKeySegment(DataLogFile* dataFile);
+        bool CommitKeySegment();
+        std::size_t ActiveExpire(std::chrono::steady_clock::time_point deadline);
 
         std::string StrGetRange(const std::string& key, std::int64_t start, std::int64_t end);
     };
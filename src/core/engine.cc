@@ -4,6 +4,8 @@
 #include "log/serverlog.h"
 #include "memory.h"
 #include "utils/utils.h"
+#include <algorithm>
+#include <filesystem>
 
 namespace foxbatdb {
     RecordObject::RecordObject() : meta{RecordObjectMeta{.logFilePtr = {}}} {}
@@ -22,52 +24,181 @@ namespace foxbatdb {
         return data.value;
     }
 
-    void RecordObject::DumpToDisk(const std::string& k, const std::string& v) {
-        if (k.empty() || v.empty()) return;
-        meta.pos = meta.logFilePtr->DumpToDisk(meta.dbIdx, k, v);
+    std::vector<std::string> RecordObject::BatchGetValue(const std::vector<std::shared_ptr<RecordObject>>& objs) {
+        std::vector<DataLogFile::Location> locations;
+        locations.reserve(objs.size());
+        for (const auto& obj: objs)
+            locations.emplace_back(obj->meta.logFilePtr, obj->meta.pos);
+
+        auto dataList = DataLogFile::BatchGetData(locations);
+
+        std::vector<std::string> values;
+        values.reserve(dataList.size());
+        for (auto& data: dataList)
+            values.emplace_back(data.error ? std::string{} : std::move(data.value));
+        return values;
+    }
+
+    void RecordObject::DumpToDisk(const std::string& k, std::string_view v) {
+        if (v.empty()) return;
+        std::uint64_t expireAtMs = HasExpiration()
+                                           ? utils::TimePointConvertToMillisecondTimestamp(meta.expirationTime)
+                                           : 0;
+        meta.pos = meta.logFilePtr->DumpToDisk(meta.dbIdx, k, v, expireAtMs);
     }
 
     void RecordObject::MarkAsDeleted(const std::string& k) {
-        DumpToDisk(k, "");
+        if (!meta.logFilePtr) return;
+        meta.logFilePtr->DumpTombstonesToDisk(meta.dbIdx, {k});
     }
 
     const DataLogFile* RecordObject::GetDataLogFileHandler() const {
         return meta.logFilePtr;
     }
 
+    void RecordObject::SetRecentlyUsed(bool used) {
+        meta.recentlyUsed = used;
+    }
+
+    bool RecordObject::IsRecentlyUsed() const {
+        return meta.recentlyUsed;
+    }
+
     void RecordObject::SetExpiration(std::chrono::seconds sec) {
         SetExpiration(std::chrono::duration_cast<std::chrono::milliseconds>(sec));
     }
 
     void RecordObject::SetExpiration(std::chrono::milliseconds ms) {
-        meta.expirationTimeMs = ms;
+        meta.expirationTime = std::chrono::steady_clock::now() + ms;
+    }
+
+    void RecordObject::SetExpirationTimePoint(std::chrono::steady_clock::time_point tp) {
+        meta.expirationTime = tp;
     }
 
     std::chrono::milliseconds RecordObject::GetExpiration() const {
-        return meta.expirationTimeMs;
+        if (!HasExpiration()) return std::chrono::milliseconds::max();
+        auto remain = std::chrono::duration_cast<std::chrono::milliseconds>(
+                meta.expirationTime - std::chrono::steady_clock::now());
+        return std::max(remain, std::chrono::milliseconds{0});
+    }
+
+    bool RecordObject::HasExpiration() const {
+        return meta.expirationTime != INVALID_EXPIRE_TIME;
+    }
+
+    std::chrono::steady_clock::time_point RecordObject::GetExpirationTimePoint() const {
+        return meta.expirationTime;
     }
 
     bool RecordObject::IsExpired() const {
-        if (meta.expirationTimeMs == std::chrono::milliseconds{ULLONG_MAX}) {
+        if (!HasExpiration()) {
             return false;
         }
-        auto exTime = meta.createdTime + meta.expirationTimeMs;
-        return std::chrono::steady_clock::now() >= exTime;
+        return std::chrono::steady_clock::now() >= GetExpirationTimePoint();
     }
 
-    MemoryIndex::MemoryIndex(std::uint8_t dbIdx) : mDBIdx_{dbIdx} {}
+    namespace {
+        // ȡ¼valueȡʧܻɾļ¼
+        std::vector<std::pair<std::string, std::string>> ReadRecordValues(MemoryIndex::RecordList&& records) {
+            std::vector<std::shared_ptr<RecordObject>> objs;
+            objs.reserve(records.size());
+            for (const auto& [_, valObj]: records)
+                objs.emplace_back(valObj);
+            auto values = RecordObject::BatchGetValue(objs);
+
+            std::vector<std::pair<std::string, std::string>> ret;
+            ret.reserve(records.size());
+            for (std::size_t i = 0; i < records.size(); ++i) {
+                if (!values[i].empty()) {
+                    ret.emplace_back(std::move(records[i].first), std::move(values[i]));
+                }
+            }
+            return ret;
+        }
+
+        std::uint64_t ExpireAtMsOf(const RecordObject& obj) {
+            return obj.HasExpiration() ? utils::TimePointConvertToMillisecondTimestamp(obj.GetExpirationTimePoint()) : 0;
+        }
+
+        // θkeyб鲢ȡǰlimit
+        template<typename List, typename KeyOf>
+        void MergeSorted(List& list, std::size_t mid, std::size_t limit, bool reverse, KeyOf&& keyOf) {
+            std::inplace_merge(list.begin(), std::next(list.begin(), static_cast<std::ptrdiff_t>(mid)), list.end(),
+                               [&](const auto& lhs, const auto& rhs) {
+                                   return reverse ? (keyOf(rhs) < keyOf(lhs)) : (keyOf(lhs) < keyOf(rhs));
+                               });
+            if (list.size() > limit) list.resize(limit);
+        }
+    }// namespace
+
+    MemoryIndex::MemoryIndex(std::uint8_t dbIdx)
+        : mDBIdx_{dbIdx}, mEngine_{IndexEngine::Create(Flags::GetInstance().dbIndexEngine.at(dbIdx))} {}
 
     MemoryIndex::MemoryIndex(MemoryIndex&& rhs) noexcept
-        : mDBIdx_{rhs.mDBIdx_}, mHATTrieTree_{std::move(rhs.mHATTrieTree_)} {}
+        : mDBIdx_{rhs.mDBIdx_}, mEngine_{std::move(rhs.mEngine_)},
+          mColdKeys_{std::move(rhs.mColdKeys_)}, mColdDeleted_{std::move(rhs.mColdDeleted_)},
+          mExpiredKeyHandler_{std::move(rhs.mExpiredKeyHandler_)} {}
 
     MemoryIndex& MemoryIndex::operator=(MemoryIndex&& rhs) noexcept {
         if (this != &rhs) {
             mDBIdx_ = rhs.mDBIdx_;
-            mHATTrieTree_ = std::move(rhs.mHATTrieTree_);
+            mEngine_ = std::move(rhs.mEngine_);
+            mColdKeys_ = std::move(rhs.mColdKeys_);
+            mColdDeleted_ = std::move(rhs.mColdDeleted_);
+            mExpiredKeyHandler_ = std::move(rhs.mExpiredKeyHandler_);
         }
         return *this;
     }
 
+    void MemoryIndex::SetExpiredKeyHandler(std::function<void(const std::string&)> handler) {
+        std::unique_lock l{mt_};
+        mExpiredKeyHandler_ = std::move(handler);
+    }
+
+    void MemoryIndex::EraseLocked(const std::string& key) {
+        mEngine_->Erase(key);
+        // ¡ֻ¼һkeyӰȷ
+        if (mColdKeys_ && mColdKeys_->MayContain(key))
+            mColdDeleted_.insert(key);
+    }
+
+    void MemoryIndex::DeleteLocked(const std::string& key, RecordObject& valObj) {
+        // ζӦļʱطţм¼ɾддļ
+        // ʱֻطŸλ֮־ɾͬддļ
+        const bool checkpointEnabled = (Flags::GetInstance().indexCheckpointCronJobPeriodMs > 0) &&
+                                       !Flags::GetInstance().diskIndexMode;
+        if (checkpointEnabled || (mColdKeys_ && (valObj.GetDataLogFileHandler() == mColdKeys_->DataFile())))
+            DataLogFileManager::GetInstance().GetWritableDataFile()->DumpTombstonesToDisk(mDBIdx_, {key});
+        else
+            valObj.MarkAsDeleted(key);
+        EraseLocked(key);
+    }
+
+    bool MemoryIndex::IsColdEntryVisible(const KeySegment::Entry& entry) const {
+        if (entry.expireAtMs && (entry.expireAtMs <= utils::GetMillisecondTimestamp()))
+            return false;
+        return !mColdDeleted_.contains(entry.key) && !mEngine_->Find(entry.key);
+    }
+
+    std::shared_ptr<RecordObject> MemoryIndex::MakeRecord(const KeySegment::Entry& entry, DataLogFile* file) const {
+        RecordObjectMeta meta{
+                .dbIdx = mDBIdx_,
+                .logFilePtr = file,
+                .pos = entry.pos,
+                .expirationTime = entry.expireAtMs
+                                          ? utils::MillisecondTimestampConvertToTimePoint(entry.expireAtMs)
+                                          : INVALID_EXPIRE_TIME};
+        return RecordObjectPool::GetInstance().Acquire(meta);
+    }
+
+    std::shared_ptr<RecordObject> MemoryIndex::FindColdLocked(const std::string& key) const {
+        if (!mColdKeys_ || mColdDeleted_.contains(key)) return nullptr;
+        auto entry = mColdKeys_->Find(key);
+        if (!entry || !IsColdEntryVisible(*entry)) return nullptr;
+        return MakeRecord(*entry, mColdKeys_->DataFile());
+    }
+
     void MemoryIndex::InsertTxFlag(RecordState txFlag, std::size_t txCmdNum) const {
         if (RecordState::kBegin != txFlag)
             assert(0 == txCmdNum);
@@ -80,32 +211,69 @@ namespace foxbatdb {
 
     void MemoryIndex::Put(const std::string& key, std::shared_ptr<RecordObject> valObj) {
         std::unique_lock l{mt_};
-        mHATTrieTree_[key] = std::move(valObj);
+        mEngine_->InsertOrAssign(key, std::move(valObj));
     }
 
-    std::error_code MemoryIndex::PutHistoryData(const std::string& key, const HistoryDataInfo& info) {
+    std::tuple<std::error_code, std::shared_ptr<RecordObject>> MemoryIndex::PutHistoryData(
+            const std::string& key, const HistoryDataInfo& info) {
         RecordObjectMeta meta{
                 .dbIdx = mDBIdx_,
                 .logFilePtr = info.logFilePtr,
                 .pos = info.pos,
-                .createdTime = utils::MicrosecondTimestampConvertToTimePoint(info.microSecondTimestamp)};
+                .expirationTime = info.expireAtMs
+                                          ? utils::MillisecondTimestampConvertToTimePoint(info.expireAtMs)
+                                          : INVALID_EXPIRE_TIME};
 
         auto valObj = RecordObjectPool::GetInstance().Acquire(meta);
         if (!valObj) [[unlikely]] {
             ServerLog::GetInstance().Error("memory allocate failed");
-            return error::RuntimeErrorCode::kMemoryOut;
+            return std::make_tuple(error::RuntimeErrorCode::kMemoryOut, nullptr);
         }
 
         {
             std::unique_lock l{mt_};
-            mHATTrieTree_[key] = valObj;
+            mEngine_->InsertOrAssign(key, valObj);
         }
-        return error::RuntimeErrorCode::kSuccess;
+        return std::make_tuple(error::RuntimeErrorCode::kSuccess, std::move(valObj));
+    }
+
+    void MemoryIndex::DelHistoryData(const std::string& key) {
+        std::unique_lock l{mt_};
+        EraseLocked(key);
+    }
+
+    std::vector<std::string> MemoryIndex::DelExpiredKeys(const std::vector<std::string>& candidates) {
+        std::vector<std::string> expiredKeys;
+
+        std::unique_lock l{mt_};
+        for (const auto& key: candidates) {
+            auto valObj = mEngine_->Find(key);
+            if (!valObj || !valObj->IsExpired())
+                continue;
+            EraseLocked(key);
+            expiredKeys.emplace_back(key);
+        }
+
+        // дɾǣ֤䲻ͬkey¼¼֮
+        auto* targetLogFile = DataLogFileManager::GetInstance().GetWritableDataFile();
+        targetLogFile->DumpTombstonesToDisk(mDBIdx_, expiredKeys);
+        return expiredKeys;
     }
 
     bool MemoryIndex::Contains(const std::string& key) const {
         std::unique_lock l{mt_};
-        return mHATTrieTree_.count(key) > 0;
+        return (mEngine_->Find(key) != nullptr) || (FindColdLocked(key) != nullptr);
+    }
+
+    MemoryIndex::RecordList MemoryIndex::Snapshot() const {
+        RecordList records;
+        std::unique_lock l{mt_};
+        records.reserve(mEngine_->Size());
+        mEngine_->ForEach([&records](const std::string& key, const IndexEngine::ValueType& val) {
+            records.emplace_back(key, val);
+            return true;
+        });
+        return records;
     }
 
     std::string MemoryIndex::Get(std::error_code& ec, const std::string& key) {
@@ -119,70 +287,277 @@ namespace foxbatdb {
         return valObj.lock()->GetValue();
     }
 
+    std::vector<std::optional<std::string>> MemoryIndex::MultiGet(const std::vector<std::string>& keys) {
+        std::vector<std::optional<std::string>> ret(keys.size());
+
+        std::vector<std::size_t> foundIdx;
+        std::vector<std::shared_ptr<RecordObject>> objs;
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (auto valObj = this->Get(keys[i]).lock(); valObj) {
+                foundIdx.emplace_back(i);
+                objs.emplace_back(std::move(valObj));
+            }
+        }
+
+        auto values = RecordObject::BatchGetValue(objs);
+        for (std::size_t i = 0; i < foundIdx.size(); ++i) {
+            if (!values[i].empty())
+                ret[foundIdx[i]] = std::move(values[i]);
+        }
+        return ret;
+    }
+
     std::weak_ptr<RecordObject> MemoryIndex::Get(const std::string& key) {
         std::unique_lock l{mt_};
-        if (!mHATTrieTree_.count(key)) {
-            return {};
+        auto valObj = mEngine_->Find(key);
+        if (!valObj) {
+            // ȡkeyڴ
+            valObj = FindColdLocked(key);
+            if (!valObj) return {};
+            mEngine_->InsertOrAssign(key, valObj);
         }
 
-        auto valObj = mHATTrieTree_.at(key);
         if (valObj->IsExpired()) {
-            valObj->MarkAsDeleted(key);
-            mHATTrieTree_.erase(key);
+            DeleteLocked(key, *valObj);
+            l.unlock();
+            if (mExpiredKeyHandler_)
+                mExpiredKeyHandler_(key);
             return {};
         }
+        valObj->SetRecentlyUsed(true);
         return valObj;
     }
 
     std::error_code MemoryIndex::Del(const std::string& key) {
         std::unique_lock l{mt_};
-        if (!mHATTrieTree_.count(key)) {
+        auto valObj = mEngine_->Find(key);
+        if (!valObj) valObj = FindColdLocked(key);
+        if (!valObj) {
             return error::RuntimeErrorCode::kKeyNotFound;
         }
 
-        auto valObj = mHATTrieTree_.at(key);
-        valObj->MarkAsDeleted(key);
-        mHATTrieTree_.erase(key);
+        DeleteLocked(key, *valObj);
         return error::RuntimeErrorCode::kSuccess;
     }
 
     std::vector<std::pair<std::string, std::string>> MemoryIndex::PrefixSearch(const std::string& prefix) const {
-        std::vector<std::pair<std::string, std::string>> ret;
+        RecordList records;
+        {
+            std::unique_lock l{mt_};
+            mEngine_->ForEachWithPrefix(prefix, [&records](const std::string& key, const IndexEngine::ValueType& val) {
+                records.emplace_back(key, val);
+                return true;
+            });
+            if (mColdKeys_) {
+                mColdKeys_->ForEachWithPrefix(prefix, [this, &records](const KeySegment::Entry& entry) {
+                    if (IsColdEntryVisible(entry))
+                        records.emplace_back(entry.key, MakeRecord(entry, mColdKeys_->DataFile()));
+                    return true;
+                });
+            }
+        }
+
+        // ̶ȡռ
+        return ReadRecordValues(std::move(records));
+    }
+
+    std::vector<std::string> MemoryIndex::PrefixKeys(const std::string& prefix, std::size_t limit) const {
+        std::vector<std::string> keys;
+        if (0 == limit) return keys;
 
         std::unique_lock l{mt_};
-        auto prefixRange = mHATTrieTree_.equal_prefix_range({prefix.data(), prefix.length()});
-        for (auto it = prefixRange.first; it != prefixRange.second; ++it) {
-            if (auto val = it.value()->GetValue(); !val.empty()) {
-                ret.emplace_back(it.key(), val);
+        mEngine_->ForEachWithPrefix(prefix, [&keys, limit](const std::string& key, const IndexEngine::ValueType& val) {
+            // ڴеԪݣȡvalue
+            if (!val->IsExpired())
+                keys.emplace_back(key);
+            return keys.size() < limit;
+        });
+
+        if (mColdKeys_) {
+            auto memoryKeyNum = keys.size();
+            mColdKeys_->ForEachWithPrefix(prefix, [this, &keys, memoryKeyNum, limit](const KeySegment::Entry& entry) {
+                if (IsColdEntryVisible(entry))
+                    keys.emplace_back(entry.key);
+                return keys.size() - memoryKeyNum < limit;
+            });
+            if (IsOrdered())
+                MergeSorted(keys, memoryKeyNum, limit, false, [](const std::string& key) -> const std::string& { return key; });
+            else if (keys.size() > limit)
+                keys.resize(limit);
+        }
+        return keys;
+    }
+
+    std::size_t MemoryIndex::PrefixCount(const std::string& prefix) const {
+        std::size_t count = 0;
+
+        std::unique_lock l{mt_};
+        mEngine_->ForEachWithPrefix(prefix, [&count](const std::string&, const IndexEngine::ValueType& val) {
+            if (!val->IsExpired()) ++count;
+            return true;
+        });
+        if (mColdKeys_) {
+            mColdKeys_->ForEachWithPrefix(prefix, [this, &count](const KeySegment::Entry& entry) {
+                if (IsColdEntryVisible(entry)) ++count;
+                return true;
+            });
+        }
+        return count;
+    }
+
+    std::tuple<std::error_code, std::uint64_t> MemoryIndex::Scan(const std::string& prefix, std::uint64_t cursor,
+                                                                 std::size_t count, RecordList& records) const {
+        std::unique_lock l{mt_};
+        if (!(cursor & COLD_SCAN_FLAG)) {
+            auto nextCursor = mEngine_->Scan(prefix, cursor, count, [&records](const std::string& key, const IndexEngine::ValueType& val) {
+                if (!val->IsExpired())
+                    records.emplace_back(key, val);
+                return true;
+            });
+            if (!nextCursor.has_value())
+                return {error::RuntimeErrorCode::kInvalidScanCursor, 0};
+            cursor = *nextCursor;
+            // ڴϺٴ0ʼ
+            return {error::RuntimeErrorCode::kSuccess, ((0 == cursor) && mColdKeys_) ? COLD_SCAN_FLAG : cursor};
+        }
+
+        if (!mColdKeys_) return {error::RuntimeErrorCode::kSuccess, 0};
+        auto nextOrdinal = mColdKeys_->Scan(prefix, cursor & ~COLD_SCAN_FLAG, count,
+                                            [this, &records](const KeySegment::Entry& entry) {
+                                                if (IsColdEntryVisible(entry))
+                                                    records.emplace_back(entry.key, MakeRecord(entry, mColdKeys_->DataFile()));
+                                                return true;
+                                            });
+        return {error::RuntimeErrorCode::kSuccess, nextOrdinal ? (nextOrdinal | COLD_SCAN_FLAG) : 0};
+    }
+
+    bool MemoryIndex::IsOrdered() const {
+        return mEngine_->IsOrdered();
+    }
+
+    bool MemoryIndex::SupportPrefix() const {
+        return mEngine_->SupportPrefix();
+    }
+
+    std::vector<std::pair<std::string, std::string>> MemoryIndex::RangeSearch(const std::string& start,
+                                                                              const std::string& end,
+                                                                              std::size_t limit, bool reverse) const {
+        if (0 == limit) return {};
+
+        RecordList records;
+        auto visitor = [&records, limit](const std::string& key, const IndexEngine::ValueType& val) {
+            if (!val->IsExpired())
+                records.emplace_back(key, val);
+            return records.size() < limit;
+        };
+        {
+            std::unique_lock l{mt_};
+            mEngine_->ForEachInRange(start, end, reverse, visitor);
+            if (mColdKeys_) {
+                auto memoryRecordNum = records.size();
+                mColdKeys_->ForEachInRange(start, end, reverse, [this, &records, memoryRecordNum, limit](const KeySegment::Entry& entry) {
+                    if (IsColdEntryVisible(entry))
+                        records.emplace_back(entry.key, MakeRecord(entry, mColdKeys_->DataFile()));
+                    return records.size() - memoryRecordNum < limit;
+                });
+                MergeSorted(records, memoryRecordNum, limit, reverse,
+                            [](const RecordList::value_type& record) -> const std::string& { return record.first; });
             }
         }
-        return ret;
+        return ReadRecordValues(std::move(records));
     }
 
-    void MemoryIndex::Merge(DataLogFile* targetFile, const DataLogFile* writableFile) {
+    std::vector<std::string> MemoryIndex::Merge(DataLogFile* targetFile, const DataLogFile* writableFile) {
         std::unique_lock l{mt_};
+        const bool diskIndexMode = Flags::GetInstance().diskIndexMode;
         std::vector<std::string> expiredKeyList;
-        for (auto it = mHATTrieTree_.cbegin(); it != mHATTrieTree_.cend(); ++it) {
-            const auto& key = it.key();
-            const auto& valObj = it.value();
-
+        std::vector<std::string> coldKeyList;
+        std::vector<KeySegment::Entry> segmentEntries;
+        mEngine_->ForEach([&](const std::string& key, const IndexEngine::ValueType& valObj) {
             if (valObj->IsExpired()) {
                 expiredKeyList.emplace_back(key);
-                continue;
+                return true;
             }
 
             // ϲǰõdbļ
             if (writableFile == valObj->GetDataLogFileHandler())
-                continue;
+                return true;
             // Ծkeyͼ¼дmergeļںٸڴ
             if (auto val = valObj->GetValue(); !val.empty()) {
-                RecordObjectMeta meta{.dbIdx = mDBIdx_, .logFilePtr = targetFile};
+                auto meta = valObj->GetMeta();// ʱ
+                meta.logFilePtr = targetFile;
                 valObj->SetMeta(meta);
                 valObj->DumpToDisk(key, val);
             }
-        }
+
+            // ģʽmergeļеkeyȫдΣϴκϲδȡkeyƳڴ
+            if (diskIndexMode && (targetFile == valObj->GetDataLogFileHandler())) {
+                segmentEntries.push_back({key, valObj->GetMeta().pos, ExpireAtMsOf(*valObj)});
+                if (!valObj->IsRecentlyUsed())
+                    coldKeyList.emplace_back(key);
+                valObj->SetRecentlyUsed(false);
+            }
+            return true;
+        });
 
         for (auto&& key: expiredKeyList)
-            mHATTrieTree_.erase(key);
+            EraseLocked(key);
+        if (!diskIndexMode) return expiredKeyList;
+
+        // Чļ¼һдmergeļ
+        std::size_t memoryEntryNum = segmentEntries.size();
+        if (mColdKeys_) {
+            auto* coldFile = mColdKeys_->DataFile();
+            mColdKeys_->ForEach([&](const KeySegment::Entry& entry) {
+                if (!IsColdEntryVisible(entry)) return true;
+                auto data = coldFile->GetDataByOffset(entry.pos);
+                if (data.error || data.value.empty()) return true;
+                segmentEntries.push_back({entry.key, targetFile->DumpToDisk(mDBIdx_, entry.key, data.value, entry.expireAtMs),
+                                          entry.expireAtMs});
+                return true;
+            });
+        }
+
+        std::sort(segmentEntries.begin(), segmentEntries.end(),
+                  [](const KeySegment::Entry& lhs, const KeySegment::Entry& rhs) { return lhs.key < rhs.key; });
+        auto segment = KeySegment::Create(KeySegment::PathOf(mDBIdx_) + ".tmp", targetFile, segmentEntries);
+        if (!segment) {
+            // ʧʱ˻ȫڴζӦļɾ
+            for (const auto& entry: segmentEntries) {
+                if (!mEngine_->Find(entry.key))
+                    mEngine_->InsertOrAssign(entry.key, MakeRecord(entry, targetFile));
+            }
+            mColdKeys_.reset();
+            mColdDeleted_.clear();
+            return expiredKeyList;
+        }
+
+        mColdKeys_ = std::move(segment);
+        mColdDeleted_.clear();
+        for (const auto& key: coldKeyList)
+            mEngine_->Erase(key);
+        ServerLog::GetInstance().Info("db {} key segment rebuilt: {} keys, {} kept in memory",
+                                      mDBIdx_, segmentEntries.size(), memoryEntryNum - coldKeyList.size());
+        return expiredKeyList;
+    }
+
+    bool MemoryIndex::LoadKeySegment(DataLogFile* dataFile) {
+        auto segment = dataFile ? KeySegment::Open(KeySegment::PathOf(mDBIdx_), dataFile) : nullptr;
+        std::unique_lock l{mt_};
+        mColdKeys_ = std::move(segment);
+        mColdDeleted_.clear();
+        return mColdKeys_ != nullptr;
+    }
+
+    bool MemoryIndex::CommitKeySegment() {
+        std::unique_lock l{mt_};
+        auto path = KeySegment::PathOf(mDBIdx_);
+        if (!mColdKeys_) {
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+            return false;
+        }
+        mColdKeys_->Rename(path);
+        return true;
     }
-}// namespace foxbatdb
\ No newline at end of file
+}// namespace foxbatdb
@@ -1,22 +1,29 @@
 #pragma once
+#include "index.h"
+#include "keysegment.h"
 #include "log/datalog.h"
-#include "tsl/htrie_map.h"
 #include <chrono>
 #include <cstdint>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <new>
 #include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_set>
 #include <vector>
 
 namespace foxbatdb {
-    constexpr static std::chrono::milliseconds INVALID_EXPIRE_TIME{ULLONG_MAX};
+    constexpr static auto INVALID_EXPIRE_TIME = std::chrono::steady_clock::time_point::max();
 
     struct RecordObjectMeta {
         std::uint8_t dbIdx = 0;
+        bool recentlyUsed = false;// 自上次合并以来被读取过，磁盘索引模式下合并时保留在内存中
         DataLogFile* logFilePtr = DataLogFileManager::GetInstance().GetWritableDataFile();
         std::streampos pos = -1;
-        std::chrono::milliseconds expirationTimeMs = INVALID_EXPIRE_TIME;
-        std::chrono::time_point<std::chrono::steady_clock> createdTime = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point expirationTime = INVALID_EXPIRE_TIME;
     };
 
     class RecordObject {
@@ -29,16 +36,24 @@ namespace foxbatdb {
         void SetMeta(const RecordObjectMeta& m);
         RecordObjectMeta GetMeta() const;
 
-        void DumpToDisk(const std::string& k, const std::string& v);
+        void DumpToDisk(const std::string& k, std::string_view v);
 
         [[nodiscard]] std::string GetValue() const;
+        // 批量读取value，按数据文件与偏移量排序后合并读取，结果顺序与请求顺序一致
+        static std::vector<std::string> BatchGetValue(const std::vector<std::shared_ptr<RecordObject>>& objs);
         void MarkAsDeleted(const std::string& k);
 
         [[nodiscard]] const DataLogFile* GetDataLogFileHandler() const;
 
+        void SetRecentlyUsed(bool used);
+        [[nodiscard]] bool IsRecentlyUsed() const;
+
         void SetExpiration(std::chrono::seconds sec);
         void SetExpiration(std::chrono::milliseconds ms);
-        [[nodiscard]] std::chrono::milliseconds GetExpiration() const;
+        void SetExpirationTimePoint(std::chrono::steady_clock::time_point tp);
+        [[nodiscard]] std::chrono::milliseconds GetExpiration() const;// 剩余生存时间
+        [[nodiscard]] bool HasExpiration() const;
+        [[nodiscard]] std::chrono::steady_clock::time_point GetExpirationTimePoint() const;
         [[nodiscard]] bool IsExpired() const;
     };
 
@@ -46,13 +61,29 @@ namespace foxbatdb {
     private:
         mutable std::mutex mt_;
         std::uint8_t mDBIdx_;
-        tsl::htrie_map<char, std::shared_ptr<RecordObject>> mHATTrieTree_;
+        std::unique_ptr<IndexEngine> mEngine_;
+        // 磁盘索引模式：冷key只保存在磁盘索引段中，内存索引中的同名key优先
+        std::unique_ptr<KeySegment> mColdKeys_;
+        std::unordered_set<std::string> mColdDeleted_;// 索引段中已被删除的key
+        std::function<void(const std::string&)> mExpiredKeyHandler_;
+
+        void EraseLocked(const std::string& key);
+        void DeleteLocked(const std::string& key, RecordObject& valObj);// 写入删除标记并移除key
+        [[nodiscard]] bool IsColdEntryVisible(const KeySegment::Entry& entry) const;
+        std::shared_ptr<RecordObject> MakeRecord(const KeySegment::Entry& entry, DataLogFile* file) const;
+        std::shared_ptr<RecordObject> FindColdLocked(const std::string& key) const;
 
     public:
+        // 磁盘索引模式下Scan游标的最高位表示已进入索引段遍历阶段
+        static constexpr std::uint64_t COLD_SCAN_FLAG = 1ULL << 63;
+
+        using RecordList = std::vector<std::pair<std::string, std::shared_ptr<RecordObject>>>;
+
         struct HistoryDataInfo {
             DataLogFile* logFilePtr = nullptr;
             std::streampos pos = -1;
             std::uint64_t microSecondTimestamp = 0;
+            std::uint64_t expireAtMs = 0;// 0表示未设置过期时间
         };
 
     public:
@@ -63,19 +94,42 @@ namespace foxbatdb {
         MemoryIndex& operator=(MemoryIndex&& rhs) noexcept;
         ~MemoryIndex() = default;
 
+        // 读取时惰性删除过期key后调用，调用时不持有索引锁
+        void SetExpiredKeyHandler(std::function<void(const std::string&)> handler);
+
         void InsertTxFlag(RecordState txFlag, std::size_t txCmdNum = 0) const;
 
         void Put(const std::string& key, std::shared_ptr<RecordObject> valObj);
-        std::error_code PutHistoryData(const std::string& key, const HistoryDataInfo& info);
+        // 返回加载的记录对象，不标记为最近使用
+        std::tuple<std::error_code, std::shared_ptr<RecordObject>> PutHistoryData(const std::string& key,
+                                                                                  const HistoryDataInfo& info);
+        void DelHistoryData(const std::string& key);
+        std::vector<std::string> DelExpiredKeys(const std::vector<std::string>& candidates);
 
         [[nodiscard]] bool Contains(const std::string& key) const;
+        // 复制全部key与记录对象的引用，不读取磁盘
+        RecordList Snapshot() const;
 
         std::string Get(std::error_code& ec, const std::string& key);
+        std::vector<std::optional<std::string>> MultiGet(const std::vector<std::string>& keys);
         std::weak_ptr<RecordObject> Get(const std::string& key);
 
         std::error_code Del(const std::string& key);
         std::vector<std::pair<std::string, std::string>> PrefixSearch(const std::string& prefix) const;
+        std::tuple<std::error_code, std::uint64_t> Scan(const std::string& prefix, std::uint64_t cursor,
+                                                         std::size_t count, RecordList& records) const;
+        std::vector<std::string> PrefixKeys(const std::string& prefix, std::size_t limit) const;
+        std::size_t PrefixCount(const std::string& prefix) const;
+
+        [[nodiscard]] bool IsOrdered() const;
+        [[nodiscard]] bool SupportPrefix() const;
+        std::vector<std::pair<std::string, std::string>> RangeSearch(const std::string& start, const std::string& end,
+                                                                     std::size_t limit, bool reverse) const;
+
+        // 返回合并时删除的过期key
+        std::vector<std::string> Merge(DataLogFile* targetFile, const DataLogFile* writableFile);
 
-        void Merge(DataLogFile* targetFile, const DataLogFile* writableFile);
+        bool LoadKeySegment(DataLogFile* dataFile);// dataFile为空时卸载索引段
+        bool CommitKeySegment();// 将合并生成的索引段重命名为正式文件
     };
 }// namespace foxbatdb
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "expire.h"
+#include <utility>
+
+namespace foxbatdb {
+    TimingWheel::TimingWheel(std::chrono::milliseconds tick)
+        : mTick_{tick.count() > 0 ? tick : std::chrono::milliseconds{1}},
+          mStartTime_{std::chrono::steady_clock::now()},
+          mCurrentTick_{0}, mSize_{0} {}
+
+    std::uint64_t TimingWheel::ToTick(TimePoint tp) const {
+        if (tp <= mStartTime_) return 0;
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(tp - mStartTime_);
+        // 向上取整，保证key不会早于其过期时间被取出
+        return static_cast<std::uint64_t>((elapsed.count() + mTick_.count() - 1) / mTick_.count());
+    }
+
+    void TimingWheel::Insert(Entry&& entry) {
+        // 选择与当前tick高位相同的最低层级，该层槽位一定位于当前槽位之后
+        for (std::size_t level = 0; level < LEVEL_NUM; ++level) {
+            auto shift = SLOT_BITS * (level + 1);
+            if (((entry.expireTick ^ mCurrentTick_) >> shift) == 0) {
+                auto slot = (entry.expireTick >> (SLOT_BITS * level)) & (SLOT_NUM - 1);
+                mSlots_[level][slot].emplace_back(std::move(entry));
+                return;
+            }
+        }
+        mOverflow_.emplace_back(std::move(entry));
+    }
+
+    void TimingWheel::Cascade(std::vector<Entry>&& entries) {
+        for (auto&& entry: entries) {
+            if (entry.expireTick < mCurrentTick_)
+                entry.expireTick = mCurrentTick_;
+            Insert(std::move(entry));
+        }
+    }
+
+    void TimingWheel::Add(const std::string& key, TimePoint expireAt) {
+        std::unique_lock l{mt_};
+        auto tick = ToTick(expireAt);
+        if (tick <= mCurrentTick_)
+            tick = mCurrentTick_ + 1;// 当前槽位已处理过，放入下一个tick
+        Insert(Entry{.key = InternedKey{key}, .expireTick = tick});
+        ++mSize_;
+    }
+
+    void TimingWheel::Advance(TimePoint now, std::deque<InternedKey>& expiredKeys) {
+        std::unique_lock l{mt_};
+        // 向下取整：只处理已完整经过的tick，否则其中尚未到期的key被提前取出后会被调用方丢弃
+        std::uint64_t targetTick = 0;
+        if (now > mStartTime_)
+            targetTick = static_cast<std::uint64_t>(
+                    std::chrono::duration_cast<std::chrono::milliseconds>(now - mStartTime_) / mTick_);
+        while (mCurrentTick_ < targetTick) {
+            ++mCurrentTick_;
+
+            // 自高层向低层级联，将即将到期的key迁移至低层时间轮
+            if (0 == (mCurrentTick_ & ((std::uint64_t{1} << (SLOT_BITS * LEVEL_NUM)) - 1))) {
+                Cascade(std::exchange(mOverflow_, {}));
+            }
+            for (std::size_t level = LEVEL_NUM - 1; level > 0; --level) {
+                if (mCurrentTick_ & ((std::uint64_t{1} << (SLOT_BITS * level)) - 1))
+                    continue;
+                auto slot = (mCurrentTick_ >> (SLOT_BITS * level)) & (SLOT_NUM - 1);
+                Cascade(std::exchange(mSlots_[level][slot], {}));
+            }
+
+            auto& dueSlot = mSlots_[0][mCurrentTick_ & (SLOT_NUM - 1)];
+            for (auto&& entry: dueSlot)
+                expiredKeys.emplace_back(std::move(entry.key));
+            mSize_ -= dueSlot.size();
+            dueSlot.clear();
+        }
+    }
+
+    std::size_t TimingWheel::Size() const {
+        std::unique_lock l{mt_};
+        return mSize_;
+    }
+}// namespace foxbatdb
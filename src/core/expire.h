@@ -0,0 +1,50 @@
+#pragma once
+#include "keypool.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace foxbatdb {
+    // 分层时间轮：记录带过期时间的key，按tick推进时批量取出到期key
+    // 到期key仅作为候选，调用方需再次确认记录确实已过期（key可能已被覆盖或删除）
+    class TimingWheel {
+    public:
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        explicit TimingWheel(std::chrono::milliseconds tick);
+        TimingWheel(const TimingWheel&) = delete;
+        TimingWheel& operator=(const TimingWheel&) = delete;
+        ~TimingWheel() = default;
+
+        void Add(const std::string& key, TimePoint expireAt);
+        void Advance(TimePoint now, std::deque<InternedKey>& expiredKeys);
+        [[nodiscard]] std::size_t Size() const;
+
+    private:
+        struct Entry {
+            InternedKey key;
+            std::uint64_t expireTick;
+        };
+
+        static constexpr std::size_t SLOT_BITS = 8;
+        static constexpr std::size_t SLOT_NUM = 1 << SLOT_BITS;
+        static constexpr std::size_t LEVEL_NUM = 4;
+
+        mutable std::mutex mt_;
+        std::chrono::milliseconds mTick_;
+        TimePoint mStartTime_;
+        std::uint64_t mCurrentTick_;
+        std::size_t mSize_;
+        std::array<std::array<std::vector<Entry>, SLOT_NUM>, LEVEL_NUM> mSlots_;
+        std::vector<Entry> mOverflow_;
+
+        [[nodiscard]] std::uint64_t ToTick(TimePoint tp) const;
+        void Insert(Entry&& entry);
+        void Cascade(std::vector<Entry>&& entries);
+    };
+}// namespace foxbatdb
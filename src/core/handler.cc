@@ -1,11 +1,13 @@
 #include "handler.h"
 #include "db.h"
+#include "tracking.h"
 #include "errors/protocol.h"
 #include "errors/runtime.h"
 #include "frontend/cmdmap.h"
 #include "frontend/server.h"
 #include "utils/resp.h"
 #include "utils/utils.h"
+#include <limits>
 
 namespace foxbatdb {
     namespace {
@@ -26,6 +28,31 @@ namespace foxbatdb {
             return ProcResult{.hasError = false, .data = {utils::OK_RESPONSE}};
         }
 
+        ProcResult ArrayResp(std::string&& resp) {
+            return ProcResult{.hasError = false, .data = std::move(resp)};
+        }
+
+        // 键值对依次编码为数组元素：key1, val1, key2, val2...
+        std::string EncodeKVList(const std::vector<std::pair<std::string, std::string>>& kvList) {
+            std::size_t totalSize = 0;
+            for (const auto& [key, val]: kvList)
+                totalSize += key.size() + val.size() + 6;
+
+            std::string resp;
+            resp.reserve(totalSize + 24);
+            utils::AppendArrayHeader(resp, kvList.size() * 2);
+            for (const auto& [key, val]: kvList) {
+                utils::AppendResponse(resp, key);
+                utils::AppendResponse(resp, val);
+            }
+            return resp;
+        }
+
+        // 默认跟踪模式下记录连接读取过的key；须在读取前登记，否则读取与登记之间的写入不会触发失效通知
+        void TrackReadKey(const std::shared_ptr<CMDSession>& clt, const std::string& key) {
+            if (TrackingMode::kKeys == clt->GetTrackingMode())
+                ClientTracking::GetInstance().TrackKey(key, clt);
+        }
     }// namespace
 
     ProcResult SwitchDB(std::weak_ptr<CMDSession> weak, const Command& cmd) {
@@ -80,7 +107,7 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kInvalidValueType);
 
         auto* db = clt->CurrentDB();
-        const auto& key = cmd.argv[0];
+        const std::string key{cmd.argv[0]};
         auto val = db->StrGet(key);
         if (val.has_value()) {
             auto& dbm = DatabaseManager::GetInstance();
@@ -93,6 +120,50 @@ namespace foxbatdb {
         return ProcResult{.hasError = true, .data = utils::BuildResponse(0)};
     }
 
+    // 仅支持CLIENT TRACKING ON|OFF [BCAST] [PREFIX prefix]...
+    ProcResult Client(std::weak_ptr<CMDSession> weak, const Command& cmd) {
+        auto clt = weak.lock();
+        if (!clt) {
+            return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
+        }
+
+        bool isOn = detail::EqualsIgnoreCase(cmd.argv[1], "on");
+        if (!detail::EqualsIgnoreCase(cmd.argv[0], "tracking") ||
+            (!isOn && !detail::EqualsIgnoreCase(cmd.argv[1], "off"))) {
+            return MakeProcResult(error::ProtocolErrorCode::kSyntax);
+        }
+
+        bool isBroadcast = false;
+        std::vector<std::string> prefixes;
+        for (const auto& opt: cmd.options) {
+            if (CmdOptionType::kBCAST == opt.type) {
+                isBroadcast = true;
+            } else if (CmdOptionType::kPREFIX == opt.type) {
+                prefixes.emplace_back(opt.argv.front());
+            }
+        }
+        if (!isBroadcast && !prefixes.empty()) {
+            return MakeProcResult(error::ProtocolErrorCode::kSyntax);// 前缀仅用于广播模式
+        }
+        if (isBroadcast && prefixes.empty()) {
+            prefixes.emplace_back();// 空前缀匹配所有key
+        }
+
+        // 重新开启时以本次指定的模式与前缀为准
+        auto& tracking = ClientTracking::GetInstance();
+        for (const auto& prefix: clt->TrackingPrefixes())
+            tracking.UntrackPrefix(prefix, weak);
+        if (!isOn) {
+            clt->SetTracking(TrackingMode::kOff, {});
+            return OKResp();
+        }
+
+        for (const auto& prefix: prefixes)
+            tracking.TrackPrefix(prefix, weak);
+        clt->SetTracking(isBroadcast ? TrackingMode::kBroadcast : TrackingMode::kKeys, std::move(prefixes));
+        return OKResp();
+    }
+
     ProcResult Watch(std::weak_ptr<CMDSession> weak, const Command& cmd) {
         auto clt = weak.lock();
         if (!clt) {
@@ -100,7 +171,7 @@ namespace foxbatdb {
         }
 
         auto* db = clt->CurrentDB();
-        db->AddWatchKeyWithClient(cmd.argv[0], weak);
+        db->AddWatchKeyWithClient(std::string{cmd.argv[0]}, weak);
         return OKResp();
     }
 
@@ -110,7 +181,7 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
         }
 
-        clt->DelWatchKey(cmd.argv[0]);
+        clt->DelWatchKey(std::string{cmd.argv[0]});
         return OKResp();
     }
 
@@ -121,7 +192,7 @@ namespace foxbatdb {
         }
 
         auto& dbm = DatabaseManager::GetInstance();
-        auto cnt = dbm.PublishWithChannel(cmd.argv[0], cmd.argv[1]);
+        auto cnt = dbm.PublishWithChannel(std::string{cmd.argv[0]}, std::string{cmd.argv[1]});
 
         return MakeProcResult(cnt);
     }
@@ -133,10 +204,12 @@ namespace foxbatdb {
         }
 
         std::string result;
+        const std::string name{cmd.name};
         auto& dbm = DatabaseManager::GetInstance();
         for (std::size_t i = 0; i < cmd.argv.size(); ++i) {
-            dbm.SubscribeWithChannel(cmd.argv[i], weak);
-            result += utils::BuildPubSubResponse(cmd.name, cmd.argv[i], i + 1);
+            const std::string channel{cmd.argv[i]};
+            dbm.SubscribeWithChannel(channel, weak);
+            result += utils::BuildPubSubResponse(name, channel, i + 1);
         }
 
         return ProcResult{.hasError = false, .data = result};
@@ -149,8 +222,8 @@ namespace foxbatdb {
         }
 
         auto& dbm = DatabaseManager::GetInstance();
-        for (const auto& channel: cmd.argv)
-            dbm.UnSubscribeWithChannel(channel, weak);
+        for (auto channel: cmd.argv)
+            dbm.UnSubscribeWithChannel(std::string{channel}, weak);
         return OKResp();
     }
 
@@ -160,8 +233,9 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
         }
 
-        auto& key = cmd.argv[0];
+        const std::string key{cmd.argv[0]};
         auto* db = clt->CurrentDB();
+        TrackReadKey(clt, key);
         auto val = db->StrGet(key);
         if (!val.has_value() || val->empty()) {
             return NilResp();
@@ -176,8 +250,9 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
         }
 
-        auto& key = cmd.argv[0];
+        const std::string key{cmd.argv[0]};
         auto* db = clt->CurrentDB();
+        TrackReadKey(clt, key);
         auto val = db->StrGet(key);
         if (!val.has_value() || val->empty()) {
             return MakeProcResult(0);
@@ -192,7 +267,7 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
         }
 
-        auto& key = cmd.argv[0];
+        const std::string key{cmd.argv[0]};
         auto start = utils::ToNumber<std::int64_t>(cmd.argv[1]);
         auto end = utils::ToNumber<std::int64_t>(cmd.argv[2]);
         if (!start.has_value() || !end.has_value()) {
@@ -200,6 +275,7 @@ namespace foxbatdb {
         }
 
         auto* db = clt->CurrentDB();
+        TrackReadKey(clt, key);
         return MakeProcResult(db->StrGetRange(key, *start, *end));
     }
 
@@ -209,16 +285,21 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
         }
 
-        std::vector<std::string> ret;
-        for (const auto& key: cmd.argv) {
-            auto val = clt->CurrentDB()->StrGet(key);
+        const std::vector<std::string> keys{cmd.argv.begin(), cmd.argv.end()};
+        for (const auto& key: keys)
+            TrackReadKey(clt, key);
+        auto values = clt->CurrentDB()->StrMultiGet(keys);
+
+        std::string resp;
+        utils::AppendArrayHeader(resp, values.size());
+        for (const auto& val: values) {
             if (!val.has_value() || val->empty()) {
-                ret.emplace_back(utils::NIL_RESPONSE);
+                resp += utils::NIL_RESPONSE;
             } else {
-                ret.emplace_back(utils::BuildResponse(*val));
+                utils::AppendResponse(resp, *val);
             }
         }
-        return MakeProcResult(ret);
+        return ArrayResp(std::move(resp));
     }
 
     ProcResult StrLength(std::weak_ptr<CMDSession> weak, const Command& cmd) {
@@ -228,7 +309,9 @@ namespace foxbatdb {
         }
 
         std::size_t len = 0;
-        auto val = clt->CurrentDB()->StrGet(cmd.argv[0]);
+        const std::string key{cmd.argv[0]};
+        TrackReadKey(clt, key);
+        auto val = clt->CurrentDB()->StrGet(key);
         if (val.has_value()) {
             len = val->size();
         }
@@ -242,17 +325,154 @@ namespace foxbatdb {
         }
 
         auto* db = clt->CurrentDB();
-        auto kvList = db->PrefixSearch(cmd.argv[0]);
+        auto [ec, kvList] = db->PrefixSearch(std::string{cmd.argv[0]});
+        if (ec)
+            return MakeProcResult(ec);
 
-        std::vector<std::string> ret;
-        ret.reserve(kvList.size() * 2);
+        return ArrayResp(EncodeKVList(kvList));
+    }
 
-        std::for_each(kvList.begin(), kvList.end(),
-                      [&ret](const std::pair<std::string, std::string>& item) {
-                          ret.emplace_back(utils::BuildResponse(item.first));
-                          ret.emplace_back(utils::BuildResponse(item.second));
-                      });
-        return MakeProcResult(ret);
+    ProcResult PrefixKeys(std::weak_ptr<CMDSession> weak, const Command& cmd) {
+        auto clt = weak.lock();
+        if (!clt) {
+            return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
+        }
+
+        auto limit = std::numeric_limits<std::size_t>::max();
+        for (const auto& opt: cmd.options) {
+            if (CmdOptionType::kLIMIT == opt.type) {
+                auto n = utils::ToNumber<std::size_t>(opt.argv[0]);
+                if (!n.has_value())
+                    return MakeProcResult(error::ProtocolErrorCode::kSyntax);
+                limit = *n;
+            }
+        }
+
+        auto* db = clt->CurrentDB();
+        auto [ec, keys] = db->PrefixKeys(std::string{cmd.argv[0]}, limit);
+        if (ec)
+            return MakeProcResult(ec);
+
+        std::string resp;
+        utils::AppendArrayHeader(resp, keys.size());
+        for (const auto& key: keys)
+            utils::AppendResponse(resp, key);
+        return ArrayResp(std::move(resp));
+    }
+
+    ProcResult PrefixCount(std::weak_ptr<CMDSession> weak, const Command& cmd) {
+        auto clt = weak.lock();
+        if (!clt) {
+            return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
+        }
+
+        auto* db = clt->CurrentDB();
+        auto [ec, n] = db->PrefixCount(std::string{cmd.argv[0]});
+        if (ec)
+            return MakeProcResult(ec);
+        return MakeProcResult(static_cast<std::int64_t>(n));
+    }
+
+    ProcResult RangeHelper(std::weak_ptr<CMDSession> weak, const Command& cmd, bool reverse) {
+        auto clt = weak.lock();
+        if (!clt) {
+            return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
+        }
+
+        auto limit = std::numeric_limits<std::size_t>::max();
+        for (const auto& opt: cmd.options) {
+            if (CmdOptionType::kLIMIT == opt.type) {
+                auto n = utils::ToNumber<std::size_t>(opt.argv[0]);
+                if (!n.has_value())
+                    return MakeProcResult(error::ProtocolErrorCode::kSyntax);
+                limit = *n;
+            }
+        }
+
+        auto* db = clt->CurrentDB();
+        auto [ec, kvList] = db->RangeSearch(std::string{cmd.argv[0]}, std::string{cmd.argv[1]}, limit, reverse);
+        if (ec)
+            return MakeProcResult(ec);
+        return ArrayResp(EncodeKVList(kvList));
+    }
+
+    ProcResult Range(std::weak_ptr<CMDSession> weak, const Command& cmd) {
+        return RangeHelper(std::move(weak), cmd, false);
+    }
+
+    ProcResult RevRange(std::weak_ptr<CMDSession> weak, const Command& cmd) {
+        return RangeHelper(std::move(weak), cmd, true);
+    }
+
+    ProcResult Scan(std::weak_ptr<CMDSession> weak, const Command& cmd) {
+        auto clt = weak.lock();
+        if (!clt) {
+            return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
+        }
+
+        auto cursor = utils::ToNumber<std::uint64_t>(cmd.argv[0]);
+        if (!cursor.has_value())
+            return MakeProcResult(error::RuntimeErrorCode::kInvalidValueType);
+
+        std::string pattern = "*";
+        std::size_t count = 10;
+        for (const auto& opt: cmd.options) {
+            if (CmdOptionType::kMATCH == opt.type) {
+                pattern = opt.argv[0];
+            } else if (CmdOptionType::kCOUNT == opt.type) {
+                auto n = utils::ToNumber<std::size_t>(opt.argv[0]);
+                if (!n.has_value() || (0 == *n))
+                    return MakeProcResult(error::ProtocolErrorCode::kSyntax);
+                count = *n;
+            }
+        }
+
+        auto* db = clt->CurrentDB();
+        std::vector<std::string> keys;
+        auto [ec, nextCursor] = db->Scan(pattern, *cursor, count, keys);
+        if (ec)
+            return MakeProcResult(ec);
+
+        std::string resp;
+        utils::AppendArrayHeader(resp, 2);
+        utils::AppendResponse(resp, std::to_string(nextCursor));
+        utils::AppendArrayHeader(resp, keys.size());
+        for (const auto& key: keys)
+            utils::AppendResponse(resp, key);
+        return ArrayResp(std::move(resp));
+    }
+
+    ProcResult PrefixScan(std::weak_ptr<CMDSession> weak, const Command& cmd) {
+        auto clt = weak.lock();
+        if (!clt) {
+            return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
+        }
+
+        auto cursor = utils::ToNumber<std::uint64_t>(cmd.argv[0]);
+        if (!cursor.has_value())
+            return MakeProcResult(error::RuntimeErrorCode::kInvalidValueType);
+
+        std::size_t count = 10;
+        for (const auto& opt: cmd.options) {
+            if (CmdOptionType::kCOUNT == opt.type) {
+                auto n = utils::ToNumber<std::size_t>(opt.argv[0]);
+                if (!n.has_value() || (0 == *n))
+                    return MakeProcResult(error::ProtocolErrorCode::kSyntax);
+                count = *n;
+            }
+        }
+
+        auto* db = clt->CurrentDB();
+        std::vector<std::pair<std::string, std::string>> kvList;
+        auto [ec, nextCursor] = db->PrefixScan(std::string{cmd.argv[1]}, *cursor, count, kvList);
+        if (ec)
+            return MakeProcResult(ec);
+
+        std::string resp;
+        utils::AppendArrayHeader(resp, 2);
+        utils::AppendResponse(resp, std::to_string(nextCursor));
+        resp += EncodeKVList(kvList);
+        return ArrayResp(std::move(resp));
     }
 
     std::pair<std::int8_t, std::chrono::milliseconds> GetMillSecondTTL(std::weak_ptr<CMDSession> weak,
@@ -262,17 +482,17 @@ namespace foxbatdb {
             return {-3, {}};
         }
 
-        auto& key = cmd.argv[0];
+        const std::string key{cmd.argv[0]};
         auto* db = clt->CurrentDB();
         auto ptr = db->Get(key);
         if (ptr.expired())
             return {-2, {}};
 
-        auto ttlMs = ptr.lock()->GetExpiration();
-        if (std::chrono::milliseconds{ULLONG_MAX} == ttlMs) {
+        auto valObj = ptr.lock();
+        if (!valObj->HasExpiration()) {
             return {-1, {}};
         }
-        return {0, ttlMs};
+        return {0, valObj->GetExpiration()};
     }
 
     ProcResult TTL(std::weak_ptr<CMDSession> weak, const Command& cmd) {
@@ -302,8 +522,8 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kMemoryOut);
         }
 
-        auto& key = cmd.argv[0];
-        auto& val = cmd.argv[1];
+        const std::string key{cmd.argv[0]};
+        auto val = cmd.argv[1];// value仅写入数据文件，无需复制
 
         auto clt = weak.lock();
         if (!clt) {
@@ -313,7 +533,8 @@ namespace foxbatdb {
         auto* db = clt->CurrentDB();
         auto [err, data] = db->StrSet(key, val, cmd.options);
         if (err) {
-            if (error::RuntimeErrorCode::kIntervalError == err)
+            if ((error::RuntimeErrorCode::kIntervalError == err) ||
+                (error::RuntimeErrorCode::kInvalidExpireTime == err))
                 return MakeProcResult(err);
             else
                 return NullResp();
@@ -339,8 +560,8 @@ namespace foxbatdb {
         }
 
         for (std::size_t i = 0; i < cmd.argv.size(); i += 2) {
-            const auto& key = cmd.argv.at(i);
-            const auto& val = cmd.argv.at(i + 1);
+            const std::string key{cmd.argv.at(i)};
+            auto val = cmd.argv.at(i + 1);
             clt->CurrentDB()->StrSet(key, val, cmd.options);
         }
 
@@ -358,9 +579,10 @@ namespace foxbatdb {
         }
 
         auto* db = clt->CurrentDB();
-        const auto& key = cmd.argv[0];
-        auto val = db->StrGet(key);
-        db->StrSet(key, val.has_value() ? (*val + cmd.argv[1]) : cmd.argv[1]);
+        const std::string key{cmd.argv[0]};
+        auto val = db->StrGet(key).value_or(std::string{});
+        val.append(cmd.argv[1]);
+        db->StrSet(key, val);
 
         return OKResp();
     }
@@ -374,8 +596,8 @@ namespace foxbatdb {
         ProcResult ret;
         int cnt = 0;
         auto* db = clt->CurrentDB();
-        for (const auto& key: cmd.argv) {
-            auto ec = db->Del(key);
+        for (auto key: cmd.argv) {
+            auto ec = db->Del(std::string{key});
             if (ec)
                 ret.hasError = true;
             else
@@ -392,8 +614,8 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
         }
 
-        const auto& oldKey = cmd.argv[0];
-        const auto& newKey = cmd.argv[1];
+        const std::string oldKey{cmd.argv[0]};
+        const std::string newKey{cmd.argv[1]};
 
         auto* db = clt->CurrentDB();
         auto val = db->StrGet(oldKey);
@@ -414,7 +636,7 @@ namespace foxbatdb {
 
     template<typename T>
         requires utils::Number<T>
-    std::tuple<std::error_code, T> NumberOperateHelper(Database* db, const std::string& key, const std::string& offsetStr) {
+    std::tuple<std::error_code, T> NumberOperateHelper(Database* db, const std::string& key, std::string_view offsetStr) {
         auto offset = utils::ToNumber<T>(offsetStr);
         if (!offset.has_value()) {
             return {error::RuntimeErrorCode::kInvalidValueType, {}};
@@ -444,7 +666,7 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
         }
 
-        const auto& key = cmd.argv[0];
+        const std::string key{cmd.argv[0]};
         auto* db = clt->CurrentDB();
         auto [ec, _] = NumberOperateHelper<std::int64_t>(db, key, "1");
         if (ec)
@@ -458,7 +680,7 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
         }
 
-        const auto& key = cmd.argv[0];
+        const std::string key{cmd.argv[0]};
         auto* db = clt->CurrentDB();
         auto [ec, _] = NumberOperateHelper<std::int64_t>(db, key, "-1");
         if (ec)
@@ -472,7 +694,7 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
         }
 
-        const auto& key = cmd.argv[0];
+        const std::string key{cmd.argv[0]};
         auto* db = clt->CurrentDB();
         auto [ec, _] = NumberOperateHelper<std::int64_t>(db, key, cmd.argv[1]);
         if (ec)
@@ -486,10 +708,10 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
         }
 
-        const auto& key = cmd.argv[0];
+        const std::string key{cmd.argv[0]};
         auto* db = clt->CurrentDB();
 
-        auto offset = cmd.argv[1];
+        std::string offset{cmd.argv[1]};
         if ('-' != offset.front())
             offset = std::string{"-"} + offset;
 
@@ -505,7 +727,7 @@ namespace foxbatdb {
             return MakeProcResult(error::RuntimeErrorCode::kIntervalError);
         }
 
-        const auto& key = cmd.argv[0];
+        const std::string key{cmd.argv[0]};
         auto* db = clt->CurrentDB();
         auto [ec, ret] = NumberOperateHelper<double>(db, key, cmd.argv[1]);
         if (ec)
@@ -16,6 +16,7 @@ namespace foxbatdb {
     ProcResult Hello(std::weak_ptr<CMDSession> weak, const Command& cmd);
     ProcResult Merge(std::weak_ptr<CMDSession> weak, const Command& cmd);
     ProcResult Move(std::weak_ptr<CMDSession> weak, const Command& cmd);
+    ProcResult Client(std::weak_ptr<CMDSession> weak, const Command& cmd);
 
     /* 事务 */
     ProcResult Watch(std::weak_ptr<CMDSession> weak, const Command& cmd);
@@ -34,6 +35,12 @@ namespace foxbatdb {
     ProcResult StrMultiGet(std::weak_ptr<CMDSession> weak, const Command& cmd);
     ProcResult StrLength(std::weak_ptr<CMDSession> weak, const Command& cmd);
     ProcResult Prefix(std::weak_ptr<CMDSession> weak, const Command& cmd);
+    ProcResult Scan(std::weak_ptr<CMDSession> weak, const Command& cmd);
+    ProcResult PrefixScan(std::weak_ptr<CMDSession> weak, const Command& cmd);
+    ProcResult PrefixKeys(std::weak_ptr<CMDSession> weak, const Command& cmd);
+    ProcResult PrefixCount(std::weak_ptr<CMDSession> weak, const Command& cmd);
+    ProcResult Range(std::weak_ptr<CMDSession> weak, const Command& cmd);
+    ProcResult RevRange(std::weak_ptr<CMDSession> weak, const Command& cmd);
     ProcResult TTL(std::weak_ptr<CMDSession> weak, const Command& cmd);
     ProcResult PTTL(std::weak_ptr<CMDSession> weak, const Command& cmd);
 
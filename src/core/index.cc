@@ -0,0 +1,393 @@
+#include "index.h"
+#include "art.h"
+#include "keypool.h"
+#include "swisstable.h"
+#include "tsl/htrie_map.h"
+#include <iterator>
+#include <list>
+#include <map>
+#include <optional>
+#include <set>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace foxbatdb {
+    namespace {
+        // 有序引擎的续扫令牌：每次未完成的遍历分配一个未使用过的游标，映射到前缀与下一个待访问的key，
+        // 按key续扫不受其间增删的影响，并发的遍历互不干扰。同一游标可重复提交（如客户端重试），
+        // 每个遍历只保留最近两个游标，其余按最近最少使用淘汰；未知的游标视为失效，不按位置猜测续扫点
+        class ScanCursorTable {
+        private:
+            static constexpr std::size_t MAX_SIZE = 1024;
+            static constexpr std::uint64_t CURSOR_END = std::uint64_t{1} << 63;// 最高位留给磁盘索引段遍历标记
+
+            struct Entry {
+                std::uint64_t cursor;
+                std::uint64_t prevCursor;// 同一遍历的上一个游标，0表示首次续扫
+                std::string prefix;
+                std::string nextKey;
+            };
+            std::list<Entry> mEntries_;// 按最近使用时间升序
+            std::unordered_map<std::uint64_t, std::list<Entry>::iterator> mIndex_;
+            std::uint64_t mNextCursor_ = 1;
+
+            void Remove(std::uint64_t cursor) {
+                if (auto it = mIndex_.find(cursor); it != mIndex_.end()) {
+                    mEntries_.erase(it->second);
+                    mIndex_.erase(it);
+                }
+            }
+
+        public:
+            // 返回续扫的起始key，游标未知或与前缀不符时返回空
+            std::optional<std::string> Find(const std::string& prefix, std::uint64_t cursor) {
+                auto it = mIndex_.find(cursor);
+                if ((it == mIndex_.end()) || (it->second->prefix != prefix))
+                    return std::nullopt;
+                mEntries_.splice(mEntries_.end(), mEntries_, it->second);
+                return it->second->nextKey;
+            }
+
+            // 为自cursor续扫得到的下一个位置分配新游标
+            std::uint64_t Save(const std::string& prefix, std::uint64_t cursor, std::string nextKey) {
+                if (auto it = mIndex_.find(cursor); (it != mIndex_.end()) && it->second->prevCursor)
+                    Remove(it->second->prevCursor);
+                if (mEntries_.size() >= MAX_SIZE)
+                    Remove(mEntries_.front().cursor);
+
+                auto nextCursor = mNextCursor_;
+                mNextCursor_ = (mNextCursor_ + 1 < CURSOR_END) ? (mNextCursor_ + 1) : 1;
+                mEntries_.emplace_back(Entry{.cursor = nextCursor, .prevCursor = cursor,
+                                             .prefix = prefix, .nextKey = std::move(nextKey)});
+                mIndex_.insert_or_assign(nextCursor, std::prev(mEntries_.end()));
+                return nextCursor;
+            }
+        };
+
+        // 无序引擎的游标遍历：游标为下一个待访问key的哈希值（取63位，最高位留给磁盘索引段遍历标记），
+        // 表示哈希值小于游标的key均已访问。增删key不改变其余key的哈希值，遍历期间始终存在的key不会被遗漏。
+        // 随增删维护按(哈希值, key)排序的二级索引，每次续扫只需一次查找，且至多访问count个key
+        class HashOrderedKeys {
+        private:
+            static constexpr unsigned HASH_BITS = 63;
+
+            std::set<std::pair<std::uint64_t, InternedKey>> mKeys_;
+
+            static std::uint64_t HashOf(std::string_view key) {
+                return std::hash<std::string_view>{}(key) >> (64 - HASH_BITS);
+            }
+
+        public:
+            void Insert(const std::string& key) {
+                mKeys_.emplace(HashOf(key), InternedKey{key});
+            }
+
+            void Erase(const std::string& key) {
+                mKeys_.erase({HashOf(key), InternedKey::Find(key)});
+            }
+
+            // 不匹配前缀的key同样计入count，与SCAN MATCH一致，单次调用可能只返回少量甚至不返回key
+            template<typename FindFn>
+            std::uint64_t Scan(const std::string& prefix, std::uint64_t cursor, std::size_t count,
+                               const IndexEngine::Visitor& visitor, FindFn&& find) const {
+                std::size_t examined = 0;
+                auto it = mKeys_.lower_bound({cursor, InternedKey{}});
+                for (; it != mKeys_.end(); ++it) {
+                    // 哈希值相同的key须在同一次返回，否则下一个游标无法区分它们
+                    if ((examined >= count) && (it->first != cursor)) break;
+                    cursor = it->first;
+                    ++examined;
+
+                    auto key = it->second.ToString();
+                    if (!key.starts_with(prefix)) continue;
+                    if (auto val = find(key); val)
+                        visitor(key, val);
+                }
+                return (it == mKeys_.end()) ? 0 : it->first;
+            }
+        };
+
+        // HAT-trie：内存紧凑，支持前缀查找，但遍历无序；游标遍历另由按哈希值排序的key句柄支持
+        class HATTrieIndexEngine : public IndexEngine {
+        private:
+            using HATTrieTree = tsl::htrie_map<char, ValueType>;
+
+            HATTrieTree mTree_;
+            HashOrderedKeys mScanKeys_;
+
+        public:
+            [[nodiscard]] bool IsOrdered() const override { return false; }
+            [[nodiscard]] bool SupportPrefix() const override { return true; }
+            [[nodiscard]] std::size_t Size() const override { return mTree_.size(); }
+
+            [[nodiscard]] ValueType Find(const std::string& key) const override {
+                auto it = mTree_.find(key);
+                return (it == mTree_.end()) ? nullptr : it.value();
+            }
+
+            void InsertOrAssign(const std::string& key, ValueType val) override {
+                auto [it, inserted] = mTree_.insert(key, val);
+                if (inserted)
+                    mScanKeys_.Insert(key);
+                else
+                    it.value() = std::move(val);
+            }
+
+            bool Erase(const std::string& key) override {
+                if (0 == mTree_.erase(key)) return false;
+                mScanKeys_.Erase(key);
+                return true;
+            }
+
+            void ForEach(const Visitor& visitor) const override {
+                for (auto it = mTree_.cbegin(); it != mTree_.cend(); ++it) {
+                    if (!visitor(it.key(), it.value())) break;
+                }
+            }
+
+            void ForEachWithPrefix(const std::string& prefix, const Visitor& visitor) const override {
+                auto prefixRange = mTree_.equal_prefix_range({prefix.data(), prefix.length()});
+                for (auto it = prefixRange.first; it != prefixRange.second; ++it) {
+                    if (!visitor(it.key(), it.value())) break;
+                }
+            }
+
+            std::optional<std::uint64_t> Scan(const std::string& prefix, std::uint64_t cursor, std::size_t count,
+                                              const Visitor& visitor) const override {
+                return mScanKeys_.Scan(prefix, cursor, count, visitor,
+                                       [this](const std::string& key) { return Find(key); });
+            }
+        };
+
+        // 有序索引：按key字典序遍历，支持区间查询与逆序遍历
+        class OrderedIndexEngine : public IndexEngine {
+        private:
+            using OrderedTree = std::map<std::string, ValueType, std::less<>>;
+
+            OrderedTree mTree_;
+            mutable ScanCursorTable mScanCursors_;
+
+            // 前缀范围的上界为首个不以prefix开头的key
+            OrderedTree::const_iterator PrefixUpperBound(const std::string& prefix) const {
+                auto upper = prefix;
+                while (!upper.empty() && (static_cast<unsigned char>(upper.back()) == 0xFF))
+                    upper.pop_back();
+                if (upper.empty()) return mTree_.end();
+                upper.back() = static_cast<char>(static_cast<unsigned char>(upper.back()) + 1);
+                return mTree_.lower_bound(upper);
+            }
+
+        public:
+            [[nodiscard]] bool IsOrdered() const override { return true; }
+            [[nodiscard]] bool SupportPrefix() const override { return true; }
+            [[nodiscard]] std::size_t Size() const override { return mTree_.size(); }
+
+            [[nodiscard]] ValueType Find(const std::string& key) const override {
+                auto it = mTree_.find(key);
+                return (it == mTree_.end()) ? nullptr : it->second;
+            }
+
+            void InsertOrAssign(const std::string& key, ValueType val) override {
+                auto [it, inserted] = mTree_.try_emplace(key, val);
+                if (!inserted)
+                    it->second = std::move(val);
+            }
+
+            bool Erase(const std::string& key) override {
+                return mTree_.erase(key) > 0;
+            }
+
+            void ForEach(const Visitor& visitor) const override {
+                for (const auto& [key, val]: mTree_) {
+                    if (!visitor(key, val)) break;
+                }
+            }
+
+            void ForEachWithPrefix(const std::string& prefix, const Visitor& visitor) const override {
+                auto last = PrefixUpperBound(prefix);
+                for (auto it = mTree_.lower_bound(prefix); it != last; ++it) {
+                    if (!visitor(it->first, it->second)) break;
+                }
+            }
+
+            void ForEachInRange(const std::string& start, const std::string& end, bool reverse,
+                                const Visitor& visitor) const override {
+                if (start > end) return;
+
+                auto first = mTree_.lower_bound(start);
+                auto last = mTree_.upper_bound(end);
+                if (!reverse) {
+                    for (auto it = first; it != last; ++it) {
+                        if (!visitor(it->first, it->second)) break;
+                    }
+                } else {
+                    for (auto it = std::make_reverse_iterator(last); it != std::make_reverse_iterator(first); ++it) {
+                        if (!visitor(it->first, it->second)) break;
+                    }
+                }
+            }
+
+            std::optional<std::uint64_t> Scan(const std::string& prefix, std::uint64_t cursor, std::size_t count,
+                                              const Visitor& visitor) const override {
+                auto it = mTree_.lower_bound(prefix);
+                auto last = PrefixUpperBound(prefix);
+                if (cursor) {
+                    auto nextKey = mScanCursors_.Find(prefix, cursor);
+                    if (!nextKey.has_value()) return std::nullopt;
+                    it = mTree_.lower_bound(*nextKey);
+                }
+
+                for (std::size_t visited = 0; (it != last) && (visited < count); ++visited) {
+                    bool proceed = visitor(it->first, it->second);
+                    ++it;
+                    if (!proceed) break;
+                }
+                if (it == last) return 0;// 遍历结束
+                return mScanCursors_.Save(prefix, cursor, it->first);
+            }
+        };
+
+        // 自适应基数树：有序，点查路径短，适合共享长前缀的key
+        class ARTIndexEngine : public IndexEngine {
+        private:
+            AdaptiveRadixTree<ValueType> mTree_;
+            mutable ScanCursorTable mScanCursors_;
+
+        public:
+            [[nodiscard]] bool IsOrdered() const override { return true; }
+            [[nodiscard]] bool SupportPrefix() const override { return true; }
+            [[nodiscard]] std::size_t Size() const override { return mTree_.Size(); }
+
+            [[nodiscard]] ValueType Find(const std::string& key) const override {
+                auto* val = mTree_.Find(key);
+                return val ? *val : nullptr;
+            }
+
+            void InsertOrAssign(const std::string& key, ValueType val) override {
+                mTree_.InsertOrAssign(key, std::move(val));
+            }
+
+            bool Erase(const std::string& key) override {
+                return mTree_.Erase(key);
+            }
+
+            void ForEach(const Visitor& visitor) const override {
+                mTree_.ForEach(visitor);
+            }
+
+            void ForEachWithPrefix(const std::string& prefix, const Visitor& visitor) const override {
+                mTree_.ForEachWithPrefix(prefix, visitor);
+            }
+
+            void ForEachInRange(const std::string& start, const std::string& end, bool reverse,
+                                const Visitor& visitor) const override {
+                if (start > end) return;
+                mTree_.ForEachInRange(&start, &end, reverse, visitor);
+            }
+
+            std::optional<std::uint64_t> Scan(const std::string& prefix, std::uint64_t cursor, std::size_t count,
+                                              const Visitor& visitor) const override {
+                auto lowerBound = prefix;
+                if (cursor) {
+                    auto nextKey = mScanCursors_.Find(prefix, cursor);
+                    if (!nextKey.has_value()) return std::nullopt;
+                    lowerBound = std::move(*nextKey);
+                }
+
+                std::size_t visited = 0;
+                bool stopped = false;
+                std::optional<std::string> nextKey;
+                mTree_.ForEachInRange(&lowerBound, nullptr, false, [&](const std::string& key, const ValueType& val) {
+                    if (!key.starts_with(prefix)) return false;
+                    if (stopped || (visited == count)) {
+                        nextKey = key;
+                        return false;
+                    }
+                    ++visited;
+                    stopped = !visitor(key, val);
+                    return true;
+                });
+
+                if (!nextKey.has_value()) return 0;// 遍历结束
+                return mScanCursors_.Save(prefix, cursor, std::move(*nextKey));
+            }
+        };
+
+        // 开放寻址哈希表：点查只需访问控制字节组与槽位，不支持前缀查找与有序遍历
+        class HashIndexEngine : public IndexEngine {
+        private:
+            SwissTable<ValueType> mTable_;
+
+            // 表内key为string_view，转换为接口要求的std::string，复用同一缓冲区
+            template<typename F>
+            static auto WithStringKey(const Visitor& visitor, F&& filter) {
+                return [&visitor, filter, buf = std::string{}](std::string_view key, const ValueType& val) mutable {
+                    if (!filter(key)) return true;
+                    buf.assign(key);
+                    return visitor(buf, val);
+                };
+            }
+
+        public:
+            [[nodiscard]] bool IsOrdered() const override { return false; }
+            [[nodiscard]] bool SupportPrefix() const override { return false; }
+            [[nodiscard]] std::size_t Size() const override { return mTable_.Size(); }
+
+            [[nodiscard]] ValueType Find(const std::string& key) const override {
+                auto* val = mTable_.Find(key);
+                return val ? *val : nullptr;
+            }
+
+            void InsertOrAssign(const std::string& key, ValueType val) override {
+                mTable_.InsertOrAssign(key, std::move(val));
+            }
+
+            bool Erase(const std::string& key) override {
+                return mTable_.Erase(key);
+            }
+
+            void ForEach(const Visitor& visitor) const override {
+                mTable_.ForEach(WithStringKey(visitor, [](std::string_view) { return true; }));
+            }
+
+            void ForEachWithPrefix(const std::string& prefix, const Visitor& visitor) const override {
+                mTable_.ForEach(WithStringKey(visitor, [&prefix](std::string_view key) { return key.starts_with(prefix); }));
+            }
+
+            // 游标即槽位下标；遍历期间发生扩容或重建时，可能重复返回或遗漏部分key
+            std::optional<std::uint64_t> Scan(const std::string& prefix, std::uint64_t cursor, std::size_t count,
+                                              const Visitor& visitor) const override {
+                std::size_t visited = 0;
+                bool stopped = false;
+                auto visitOne = WithStringKey(visitor, [](std::string_view) { return true; });
+                auto slot = mTable_.ForEachFromSlot(cursor, [&](std::string_view key, const ValueType& val) {
+                    if (!key.starts_with(prefix)) return true;
+                    if (visited == count) return false;
+                    ++visited;
+                    stopped = !visitOne(key, val);
+                    return !stopped;
+                });
+
+                if (stopped) ++slot;
+                return (slot >= mTable_.Capacity()) ? 0 : slot;
+            }
+        };
+    }// namespace
+
+    void IndexEngine::ForEachInRange(const std::string&, const std::string&, bool, const Visitor&) const {}
+
+    std::unique_ptr<IndexEngine> IndexEngine::Create(IndexEngineEnum type) {
+        switch (type) {
+            case IndexEngineEnum::eOrdered:
+                return std::make_unique<OrderedIndexEngine>();
+            case IndexEngineEnum::eART:
+                return std::make_unique<ARTIndexEngine>();
+            case IndexEngineEnum::eHash:
+                return std::make_unique<HashIndexEngine>();
+            case IndexEngineEnum::eHATTrie:
+            default:
+                return std::make_unique<HATTrieIndexEngine>();
+        }
+    }
+}// namespace foxbatdb
@@ -0,0 +1,39 @@
+#pragma once
+#include "flag/flags.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace foxbatdb {
+    class RecordObject;
+
+    // 内存索引引擎接口，并发控制由MemoryIndex负责
+    class IndexEngine {
+    public:
+        using ValueType = std::shared_ptr<RecordObject>;
+        using Visitor = std::function<bool(const std::string& key, const ValueType& val)>;// 返回false时终止遍历
+
+        virtual ~IndexEngine() = default;
+
+        [[nodiscard]] virtual bool IsOrdered() const = 0;
+        [[nodiscard]] virtual bool SupportPrefix() const = 0;// 不支持时前缀遍历退化为全量遍历
+        [[nodiscard]] virtual std::size_t Size() const = 0;
+
+        [[nodiscard]] virtual ValueType Find(const std::string& key) const = 0;
+        virtual void InsertOrAssign(const std::string& key, ValueType val) = 0;
+        virtual bool Erase(const std::string& key) = 0;
+
+        virtual void ForEach(const Visitor& visitor) const = 0;
+        virtual void ForEachWithPrefix(const std::string& prefix, const Visitor& visitor) const = 0;
+        // 按字典序遍历闭区间[start, end]内的key，仅有序引擎支持
+        virtual void ForEachInRange(const std::string& start, const std::string& end, bool reverse,
+                                    const Visitor& visitor) const;
+        // 自cursor处继续遍历前缀范围内至多count个key，返回下一个游标，0表示遍历结束；游标无效或已失效时返回空
+        virtual std::optional<std::uint64_t> Scan(const std::string& prefix, std::uint64_t cursor,
+                                                  std::size_t count, const Visitor& visitor) const = 0;
+
+        static std::unique_ptr<IndexEngine> Create(IndexEngineEnum type);
+    };
+}// namespace foxbatdb
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace foxbatdb {
+    // key的连续存储区，按块分配；删除的key只记为碎片，碎片过多时由调用方重建
+    class KeyArena {
+    private:
+        static constexpr std::size_t CHUNK_SIZE = 64 * 1024;
+
+        std::vector<std::unique_ptr<char[]>> mChunks_;
+        std::vector<std::unique_ptr<char[]>> mLargeKeys_;// 大key单独分配，避免浪费块尾部空间
+        std::size_t mChunkUsed_ = CHUNK_SIZE;
+        std::size_t mLiveBytes_ = 0;
+        std::size_t mWastedBytes_ = 0;
+
+    public:
+        std::string_view Store(std::string_view key) {
+            if (key.empty()) return {};// 空key不占空间，也避免在尚未分配块时访问mChunks_.back()
+            if (key.size() > CHUNK_SIZE / 4) {
+                auto* p = mLargeKeys_.emplace_back(new char[key.size()]).get();
+                std::memcpy(p, key.data(), key.size());
+                mLiveBytes_ += key.size();
+                return {p, key.size()};
+            }
+            if (mChunkUsed_ + key.size() > CHUNK_SIZE) {
+                mChunks_.emplace_back(new char[CHUNK_SIZE]);
+                mChunkUsed_ = 0;
+            }
+            auto* p = mChunks_.back().get() + mChunkUsed_;
+            std::memcpy(p, key.data(), key.size());
+            mChunkUsed_ += key.size();
+            mLiveBytes_ += key.size();
+            return {p, key.size()};
+        }
+
+        void Release(std::string_view key) {
+            mLiveBytes_ -= key.size();
+            mWastedBytes_ += key.size();
+        }
+
+        [[nodiscard]] bool NeedCompact() const {
+            return (mWastedBytes_ > CHUNK_SIZE) && (mWastedBytes_ > mLiveBytes_);
+        }
+    };
+}// namespace foxbatdb
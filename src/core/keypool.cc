@@ -0,0 +1,188 @@
+#include "keypool.h"
+
+namespace foxbatdb {
+    namespace {
+        constexpr std::string_view KEY_DELIMITERS = ":/|.#";
+        constexpr std::size_t PREFIX_MIN_SIZE = 4;// 过短的前缀共享收益不足以抵消前缀表的开销
+
+        std::string_view StoreBytes(KeyArena& arena, std::string_view bytes) {
+            return bytes.empty() ? std::string_view{} : arena.Store(bytes);
+        }
+    }// namespace
+
+    KeyPool& KeyPool::GetInstance() {
+        static KeyPool instance;
+        return instance;
+    }
+
+    void KeyPool::Init() {}
+
+    std::pair<std::string_view, std::string_view> KeyPool::Split(std::string_view key) {
+        auto pos = key.find_last_of(KEY_DELIMITERS);
+        if ((std::string_view::npos == pos) || (pos + 1 < PREFIX_MIN_SIZE))
+            return {{}, key};
+        return {key.substr(0, pos + 1), key.substr(pos + 1)};
+    }
+
+    std::size_t KeyPool::ShardOf(std::string_view key) {
+        return std::hash<std::string_view>{}(key) & (SHARD_NUM - 1);
+    }
+
+    std::uint32_t KeyPool::AcquirePrefix(Shard& shard, std::string_view prefix) {
+        if (auto it = shard.prefixIndex.find(prefix); it != shard.prefixIndex.end()) {
+            ++shard.prefixes[it->second].refCount;
+            return it->second + 1;
+        }
+
+        std::uint32_t idx;
+        if (!shard.freePrefixes.empty()) {
+            idx = shard.freePrefixes.back();
+            shard.freePrefixes.pop_back();
+        } else {
+            idx = static_cast<std::uint32_t>(shard.prefixes.size());
+            shard.prefixes.emplace_back();
+        }
+        shard.prefixes[idx] = Prefix{.bytes = StoreBytes(shard.arena, prefix), .refCount = 1};
+        shard.prefixIndex.emplace(shard.prefixes[idx].bytes, idx);
+        return idx + 1;
+    }
+
+    void KeyPool::ReleasePrefix(Shard& shard, std::uint32_t prefixIdx) {
+        auto& prefix = shard.prefixes[prefixIdx - 1];
+        if (--prefix.refCount > 0) return;
+
+        shard.prefixIndex.erase(prefix.bytes);
+        shard.arena.Release(prefix.bytes);
+        prefix = Prefix{};
+        shard.freePrefixes.emplace_back(prefixIdx - 1);
+    }
+
+    void KeyPool::Compact(Shard& shard) {
+        // 将存活的前缀与后缀复制到新的存储区，并重建指向其的索引
+        KeyArena arena;
+        shard.prefixIndex.clear();
+        for (std::uint32_t i = 0; i < shard.prefixes.size(); ++i) {
+            auto& prefix = shard.prefixes[i];
+            if (0 == prefix.refCount) continue;
+            prefix.bytes = StoreBytes(arena, prefix.bytes);
+            shard.prefixIndex.emplace(prefix.bytes, i);
+        }
+
+        shard.slotIndex.clear();
+        for (std::uint32_t i = 0; i < shard.slots.size(); ++i) {
+            auto& slot = shard.slots[i];
+            if (0 == slot.refCount) continue;
+            slot.suffix = StoreBytes(arena, slot.suffix);
+            shard.slotIndex.emplace(SlotKey{slot.prefixIdx, slot.suffix}, i);
+        }
+        shard.arena = std::move(arena);
+    }
+
+    KeyPool::Handle KeyPool::Intern(std::string_view key) {
+        auto [prefix, suffix] = Split(key);
+        auto shardIdx = ShardOf(key);
+        auto& shard = mShards_[shardIdx];
+        auto toHandle = [shardIdx](std::uint32_t slotIdx) {
+            return static_cast<Handle>(((slotIdx + 1) << SHARD_BITS) | shardIdx);
+        };
+
+        std::unique_lock l{shard.mt};
+        std::uint32_t prefixIdx = 0;
+        if (!prefix.empty()) {
+            auto it = shard.prefixIndex.find(prefix);
+            prefixIdx = (it != shard.prefixIndex.end()) ? (it->second + 1) : 0;
+        }
+        if (prefix.empty() || prefixIdx) {
+            if (auto it = shard.slotIndex.find(SlotKey{prefixIdx, suffix}); it != shard.slotIndex.end()) {
+                ++shard.slots[it->second].refCount;
+                return toHandle(it->second);
+            }
+        }
+
+        std::uint32_t slotIdx;
+        if (!shard.freeSlots.empty()) {
+            slotIdx = shard.freeSlots.back();
+            shard.freeSlots.pop_back();
+        } else {
+            slotIdx = static_cast<std::uint32_t>(shard.slots.size());
+            shard.slots.emplace_back();
+        }
+        auto& slot = shard.slots[slotIdx];
+        slot.prefixIdx = prefix.empty() ? 0 : AcquirePrefix(shard, prefix);
+        slot.refCount = 1;
+        slot.suffix = StoreBytes(shard.arena, suffix);
+        shard.slotIndex.emplace(SlotKey{slot.prefixIdx, slot.suffix}, slotIdx);
+        return toHandle(slotIdx);
+    }
+
+    KeyPool::Handle KeyPool::Find(std::string_view key) {
+        auto [prefix, suffix] = Split(key);
+        auto shardIdx = ShardOf(key);
+        auto& shard = mShards_[shardIdx];
+
+        std::unique_lock l{shard.mt};
+        std::uint32_t prefixIdx = 0;
+        if (!prefix.empty()) {
+            auto it = shard.prefixIndex.find(prefix);
+            if (it == shard.prefixIndex.end()) return 0;
+            prefixIdx = it->second + 1;
+        }
+
+        auto it = shard.slotIndex.find(SlotKey{prefixIdx, suffix});
+        if (it == shard.slotIndex.end()) return 0;
+        ++shard.slots[it->second].refCount;
+        return static_cast<Handle>(((it->second + 1) << SHARD_BITS) | shardIdx);
+    }
+
+    void KeyPool::Retain(Handle handle) {
+        if (0 == handle) return;
+        auto& shard = mShards_[handle & (SHARD_NUM - 1)];
+        std::unique_lock l{shard.mt};
+        ++shard.slots[(handle >> SHARD_BITS) - 1].refCount;
+    }
+
+    void KeyPool::Release(Handle handle) {
+        if (0 == handle) return;
+        auto& shard = mShards_[handle & (SHARD_NUM - 1)];
+        auto slotIdx = (handle >> SHARD_BITS) - 1;
+
+        std::unique_lock l{shard.mt};
+        auto& slot = shard.slots[slotIdx];
+        if (--slot.refCount > 0) return;
+
+        shard.slotIndex.erase(SlotKey{slot.prefixIdx, slot.suffix});
+        shard.arena.Release(slot.suffix);
+        if (slot.prefixIdx)
+            ReleasePrefix(shard, slot.prefixIdx);
+        slot = Slot{};
+        shard.freeSlots.emplace_back(slotIdx);
+
+        if (shard.arena.NeedCompact())
+            Compact(shard);
+    }
+
+    std::string KeyPool::Resolve(Handle handle) const {
+        if (0 == handle) return {};
+        const auto& shard = mShards_[handle & (SHARD_NUM - 1)];
+
+        std::unique_lock l{shard.mt};
+        const auto& slot = shard.slots[(handle >> SHARD_BITS) - 1];
+        std::string key;
+        if (slot.prefixIdx) {
+            const auto& prefix = shard.prefixes[slot.prefixIdx - 1].bytes;
+            key.reserve(prefix.size() + slot.suffix.size());
+            key.append(prefix);
+        }
+        key.append(slot.suffix);
+        return key;
+    }
+
+    std::size_t KeyPool::Size() const {
+        std::size_t size = 0;
+        for (const auto& shard: mShards_) {
+            std::unique_lock l{shard.mt};
+            size += shard.slotIndex.size();
+        }
+        return size;
+    }
+}// namespace foxbatdb
@@ -0,0 +1,117 @@
+#pragma once
+#include "keyarena.h"
+#include <array>
+#include <compare>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace foxbatdb {
+    // 共享key池：LRU、watch、过期跟踪等二级结构共用同一份key字节，只持有4字节的句柄（引用计数）；
+    // key在最后一个分隔符处拆分为前缀与后缀，同一分片内相同的前缀只存储一份
+    class KeyPool {
+    public:
+        using Handle = std::uint32_t;// 低位为分片编号，高位为槽位编号加一；0表示空句柄
+
+    private:
+        static constexpr std::size_t SHARD_BITS = 4;
+        static constexpr std::size_t SHARD_NUM = 1 << SHARD_BITS;
+
+        struct Prefix {
+            std::string_view bytes;// 指向分片的KeyArena
+            std::uint32_t refCount = 0;
+        };
+
+        struct Slot {
+            std::uint32_t prefixIdx = 0;// 前缀编号加一，0表示无前缀
+            std::uint32_t refCount = 0;
+            std::string_view suffix;
+        };
+
+        struct SlotKey {
+            std::uint32_t prefixIdx;
+            std::string_view suffix;
+            bool operator==(const SlotKey&) const = default;
+        };
+
+        struct SlotKeyHash {
+            std::size_t operator()(const SlotKey& k) const {
+                return std::hash<std::string_view>{}(k.suffix) ^ (std::size_t{k.prefixIdx} * 0x9E3779B97F4A7C15ULL);
+            }
+        };
+
+        struct Shard {
+            mutable std::mutex mt;
+            KeyArena arena;
+            std::vector<Prefix> prefixes;
+            std::vector<std::uint32_t> freePrefixes;
+            std::unordered_map<std::string_view, std::uint32_t> prefixIndex;
+            std::vector<Slot> slots;
+            std::vector<std::uint32_t> freeSlots;
+            std::unordered_map<SlotKey, std::uint32_t, SlotKeyHash> slotIndex;
+        };
+
+        std::array<Shard, SHARD_NUM> mShards_;
+
+        KeyPool() = default;
+
+        static std::pair<std::string_view, std::string_view> Split(std::string_view key);
+        static std::size_t ShardOf(std::string_view key);
+
+        std::uint32_t AcquirePrefix(Shard& shard, std::string_view prefix);
+        void ReleasePrefix(Shard& shard, std::uint32_t prefixIdx);
+        void Compact(Shard& shard);
+
+    public:
+        KeyPool(const KeyPool&) = delete;
+        KeyPool& operator=(const KeyPool&) = delete;
+        ~KeyPool() = default;
+        static KeyPool& GetInstance();
+        void Init();
+
+        // 返回的句柄已持有一次引用
+        Handle Intern(std::string_view key);
+        // key不在池中时返回空句柄，不新增key；返回的非空句柄同样持有一次引用
+        Handle Find(std::string_view key);
+        void Retain(Handle handle);
+        void Release(Handle handle);
+        [[nodiscard]] std::string Resolve(Handle handle) const;
+        [[nodiscard]] std::size_t Size() const;
+    };
+
+    // KeyPool句柄的RAII封装，可用作容器的key；相等的key必然持有相同的句柄
+    class InternedKey {
+    private:
+        KeyPool::Handle mHandle_ = 0;
+
+        explicit InternedKey(KeyPool::Handle handle) : mHandle_{handle} {}
+
+    public:
+        struct Hash {
+            std::size_t operator()(const InternedKey& key) const { return std::hash<KeyPool::Handle>{}(key.mHandle_); }
+        };
+
+        InternedKey() = default;
+        explicit InternedKey(std::string_view key) : mHandle_{KeyPool::GetInstance().Intern(key)} {}
+        InternedKey(const InternedKey& rhs) : mHandle_{rhs.mHandle_} { KeyPool::GetInstance().Retain(mHandle_); }
+        InternedKey(InternedKey&& rhs) noexcept : mHandle_{std::exchange(rhs.mHandle_, 0)} {}
+        InternedKey& operator=(InternedKey rhs) noexcept {
+            std::swap(mHandle_, rhs.mHandle_);
+            return *this;
+        }
+        ~InternedKey() { KeyPool::GetInstance().Release(mHandle_); }
+
+        static InternedKey Find(std::string_view key) { return InternedKey{KeyPool::GetInstance().Find(key)}; }
+
+        [[nodiscard]] bool Empty() const { return 0 == mHandle_; }
+        [[nodiscard]] std::string ToString() const { return KeyPool::GetInstance().Resolve(mHandle_); }
+
+        // 按句柄比较，仅保证顺序稳定，与key的字典序无关
+        auto operator<=>(const InternedKey&) const = default;
+    };
+}// namespace foxbatdb
@@ -0,0 +1,363 @@
+#include "keysegment.h"
+#include "flag/flags.h"
+#include "log/serverlog.h"
+#include "utils/binary.h"
+#include "utils/utils.h"
+#include <algorithm>
+#include <filesystem>
+#include <string_view>
+
+namespace foxbatdb {
+    namespace {
+        // 文件格式（整数均为大端序）：
+        // 数据块[(key, 偏移量, 过期时间)...] | 块索引[(首个key, 块偏移, 块大小, crc, 首条目序号, 布隆过滤器)...] |
+        // 尾部(块索引偏移, 块索引大小, 条目总数, 块索引crc, magic)
+        constexpr std::string_view SEGMENT_MAGIC = "FOXBATKS";
+        constexpr std::string_view MANIFEST_MAGIC = "FOXBATKM";
+        constexpr std::size_t FOOTER_SIZE = 3 * sizeof(std::uint64_t) + sizeof(std::uint32_t) + SEGMENT_MAGIC.size();
+        constexpr std::size_t BLOCK_TARGET_SIZE = 4096;
+        constexpr std::size_t FILTER_BITS_PER_KEY = 10;
+        constexpr std::size_t FILTER_HASH_NUM = 7;
+
+        std::uint32_t Checksum(std::string_view buf) {
+            return utils::CRC(buf.data(), buf.size()) ^ utils::CRC_INIT_VALUE;
+        }
+
+        // FNV-1a，须在不同进程间保持一致，不能使用std::hash
+        std::uint64_t KeyHash(std::string_view key) {
+            std::uint64_t h = 14695981039346656037ULL;
+            for (auto c: key) {
+                h ^= static_cast<unsigned char>(c);
+                h *= 1099511628211ULL;
+            }
+            return h;
+        }
+
+        // 双重哈希生成FILTER_HASH_NUM个比特位
+        template<typename F>
+        void ForEachFilterBit(std::string_view key, std::size_t bitNum, F&& f) {
+            auto h = KeyHash(key);
+            auto delta = (h >> 17) | (h << 47);
+            for (std::size_t i = 0; i < FILTER_HASH_NUM; ++i) {
+                f(h % bitNum);
+                h += delta;
+            }
+        }
+
+        std::string ManifestPath() {
+            return Flags::GetInstance().dbLogFileDir + "/foxbat-keys.manifest";
+        }
+
+        bool WriteFileAtomically(const std::string& path, const std::string& buf) {
+            auto tmpPath = path + ".tmp";
+            {
+                std::ofstream out{tmpPath, std::ios::binary | std::ios::trunc};
+                out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+                out.flush();
+                if (!out) return false;
+            }
+            std::error_code ec;
+            std::filesystem::rename(tmpPath, path, ec);
+            return !ec;
+        }
+
+        bool ReadWholeFile(const std::string& path, std::string& buf) {
+            std::error_code ec;
+            auto size = std::filesystem::file_size(path, ec);
+            if (ec) return false;
+
+            buf.resize(size);
+            std::ifstream in{path, std::ios::binary};
+            in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+            return static_cast<bool>(in);
+        }
+    }// namespace
+
+    KeySegment::KeySegment(std::string path, DataLogFile* dataFile)
+        : mPath_{std::move(path)}, mFile_{mPath_, std::ios::binary}, mDataFile_{dataFile} {}
+
+    std::string KeySegment::PathOf(std::uint8_t dbIdx) {
+        return Flags::GetInstance().dbLogFileDir + "/foxbat-keys-" + std::to_string(dbIdx) + ".seg";
+    }
+
+    std::unique_ptr<KeySegment> KeySegment::Create(const std::string& path, DataLogFile* dataFile,
+                                                   const std::vector<Entry>& entries) {
+        std::string data;
+        std::string index;
+        std::uint32_t blockNum = 0;
+
+        std::size_t blockStart = 0;
+        while (blockStart < entries.size()) {
+            // 按目标大小切分数据块
+            auto blockOffset = data.size();
+            auto blockEnd = blockStart;
+            while ((blockEnd < entries.size()) && (data.size() - blockOffset < BLOCK_TARGET_SIZE)) {
+                const auto& entry = entries[blockEnd++];
+                utils::AppendLengthPrefixed(data, entry.key);
+                utils::AppendBigEndian(data, static_cast<std::uint64_t>(static_cast<std::streamoff>(entry.pos)));
+                utils::AppendBigEndian(data, entry.expireAtMs);
+            }
+
+            auto bitNum = std::max<std::size_t>(64, (blockEnd - blockStart) * FILTER_BITS_PER_KEY);
+            std::vector<std::uint64_t> filter((bitNum + 63) / 64, 0);
+            for (auto i = blockStart; i < blockEnd; ++i) {
+                ForEachFilterBit(entries[i].key, filter.size() * 64, [&filter](std::size_t bit) {
+                    filter[bit / 64] |= (std::uint64_t{1} << (bit % 64));
+                });
+            }
+
+            auto blockSize = data.size() - blockOffset;
+            utils::AppendLengthPrefixed(index, entries[blockStart].key);
+            utils::AppendBigEndian(index, static_cast<std::uint64_t>(blockOffset));
+            utils::AppendBigEndian(index, static_cast<std::uint32_t>(blockSize));
+            utils::AppendBigEndian(index, Checksum(std::string_view{data}.substr(blockOffset, blockSize)));
+            utils::AppendBigEndian(index, static_cast<std::uint64_t>(blockStart));
+            utils::AppendBigEndian(index, static_cast<std::uint32_t>(filter.size()));
+            for (auto word: filter)
+                utils::AppendBigEndian(index, word);
+
+            ++blockNum;
+            blockStart = blockEnd;
+        }
+
+        auto indexOffset = data.size();
+        utils::AppendBigEndian(data, blockNum);
+        data.append(index);
+        auto indexSize = data.size() - indexOffset;
+        auto indexCrc = Checksum(std::string_view{data}.substr(indexOffset, indexSize));
+
+        utils::AppendBigEndian(data, static_cast<std::uint64_t>(indexOffset));
+        utils::AppendBigEndian(data, static_cast<std::uint64_t>(indexSize));
+        utils::AppendBigEndian(data, static_cast<std::uint64_t>(entries.size()));
+        utils::AppendBigEndian(data, indexCrc);
+        data.append(SEGMENT_MAGIC);
+
+        if (!WriteFileAtomically(path, data)) {
+            ServerLog::GetInstance().Error("key segment write failed: {}", path);
+            return nullptr;
+        }
+        return Open(path, dataFile);
+    }
+
+    std::unique_ptr<KeySegment> KeySegment::Open(const std::string& path, DataLogFile* dataFile) {
+        std::unique_ptr<KeySegment> segment{new KeySegment{path, dataFile}};
+        auto& file = segment->mFile_;
+        if (!file.is_open()) return nullptr;
+
+        // 读取尾部
+        file.seekg(0, std::ios::end);
+        auto fileSize = static_cast<std::uint64_t>(static_cast<std::streamoff>(file.tellg()));
+        if (fileSize < FOOTER_SIZE) return nullptr;
+
+        std::string footer(FOOTER_SIZE, '\0');
+        file.seekg(static_cast<std::streamoff>(fileSize - FOOTER_SIZE));
+        if (!file.read(footer.data(), static_cast<std::streamsize>(footer.size()))) return nullptr;
+        if (!std::string_view{footer}.ends_with(SEGMENT_MAGIC)) return nullptr;
+
+        utils::BinaryReader footerReader{footer};
+        auto indexOffset = footerReader.Read<std::uint64_t>();
+        auto indexSize = footerReader.Read<std::uint64_t>();
+        segment->mEntryNum_ = footerReader.Read<std::uint64_t>();
+        auto indexCrc = footerReader.Read<std::uint32_t>();
+        if (indexOffset + indexSize + FOOTER_SIZE != fileSize) return nullptr;
+
+        // 读取块索引，常驻内存
+        std::string index(indexSize, '\0');
+        file.seekg(static_cast<std::streamoff>(indexOffset));
+        if (!file.read(index.data(), static_cast<std::streamsize>(index.size()))) return nullptr;
+        if (Checksum(index) != indexCrc) return nullptr;
+
+        utils::BinaryReader reader{index};
+        auto blockNum = reader.Read<std::uint32_t>();
+        segment->mBlocks_.reserve(blockNum);
+        for (std::uint32_t i = 0; (i < blockNum) && reader.OK(); ++i) {
+            Block block;
+            block.firstKey = std::string{reader.ReadLengthPrefixed()};
+            block.offset = reader.Read<std::uint64_t>();
+            block.size = reader.Read<std::uint32_t>();
+            block.crc = reader.Read<std::uint32_t>();
+            block.firstOrdinal = reader.Read<std::uint64_t>();
+            block.filter.resize(reader.Read<std::uint32_t>());
+            for (auto& word: block.filter)
+                word = reader.Read<std::uint64_t>();
+            if (block.filter.empty() || (block.offset + block.size > indexOffset)) return nullptr;
+            segment->mBlocks_.emplace_back(std::move(block));
+        }
+        if (!reader.OK() || !reader.Empty()) return nullptr;
+
+        file.clear();
+        return segment;
+    }
+
+    bool KeySegment::WriteManifest(std::uint64_t dataFileSize, std::size_t dbNum) {
+        std::string buf{MANIFEST_MAGIC};
+        utils::AppendBigEndian(buf, dataFileSize);
+        utils::AppendBigEndian(buf, static_cast<std::uint32_t>(dbNum));
+        utils::AppendBigEndian(buf, Checksum(buf));
+        return WriteFileAtomically(ManifestPath(), buf);
+    }
+
+    bool KeySegment::ValidateManifest(std::uint64_t dataFileSize, std::size_t dbNum) {
+        std::string buf;
+        if (!ReadWholeFile(ManifestPath(), buf)) return false;
+        if (!buf.starts_with(MANIFEST_MAGIC) || (buf.size() < MANIFEST_MAGIC.size() + sizeof(std::uint32_t))) return false;
+
+        auto body = std::string_view{buf}.substr(0, buf.size() - sizeof(std::uint32_t));
+        utils::BinaryReader reader{std::string_view{buf}.substr(MANIFEST_MAGIC.size())};
+        auto size = reader.Read<std::uint64_t>();
+        auto num = reader.Read<std::uint32_t>();
+        auto crc = reader.Read<std::uint32_t>();
+        return reader.OK() && reader.Empty() && (crc == Checksum(body)) &&
+               (size == dataFileSize) && (num == dbNum);
+    }
+
+    void KeySegment::RemoveManifest() {
+        std::error_code ec;
+        std::filesystem::remove(ManifestPath(), ec);
+    }
+
+    void KeySegment::Rename(const std::string& newPath) {
+        std::unique_lock l{mt_};
+        mFile_.close();
+        std::filesystem::rename(mPath_, newPath);
+        mPath_ = newPath;
+        mFile_.open(mPath_, std::ios::binary);
+    }
+
+    DataLogFile* KeySegment::DataFile() const { return mDataFile_; }
+    std::uint64_t KeySegment::Size() const { return mEntryNum_; }
+
+    std::size_t KeySegment::FindBlock(const std::string& key) const {
+        auto it = std::upper_bound(mBlocks_.begin(), mBlocks_.end(), key,
+                                   [](const std::string& k, const Block& b) { return k < b.firstKey; });
+        return (it == mBlocks_.begin()) ? 0 : static_cast<std::size_t>(std::distance(mBlocks_.begin(), it) - 1);
+    }
+
+    std::size_t KeySegment::FindBlockByOrdinal(std::uint64_t ordinal) const {
+        auto it = std::upper_bound(mBlocks_.begin(), mBlocks_.end(), ordinal,
+                                   [](std::uint64_t o, const Block& b) { return o < b.firstOrdinal; });
+        return (it == mBlocks_.begin()) ? 0 : static_cast<std::size_t>(std::distance(mBlocks_.begin(), it) - 1);
+    }
+
+    bool KeySegment::BlockMayContain(std::size_t blockIdx, const std::string& key) const {
+        const auto& filter = mBlocks_[blockIdx].filter;
+        bool mayContain = true;
+        ForEachFilterBit(key, filter.size() * 64, [&filter, &mayContain](std::size_t bit) {
+            mayContain = mayContain && (filter[bit / 64] & (std::uint64_t{1} << (bit % 64)));
+        });
+        return mayContain;
+    }
+
+    std::vector<KeySegment::Entry> KeySegment::ReadBlock(std::size_t blockIdx) const {
+        const auto& block = mBlocks_[blockIdx];
+        std::string buf(block.size, '\0');
+        {
+            std::unique_lock l{mt_};
+            mFile_.clear();
+            mFile_.seekg(static_cast<std::streamoff>(block.offset));
+            mFile_.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+            if (!mFile_ || (Checksum(buf) != block.crc)) {
+                ServerLog::GetInstance().Error("key segment {} block {} corrupted", mPath_, blockIdx);
+                return {};
+            }
+        }
+
+        std::vector<Entry> entries;
+        utils::BinaryReader reader{buf};
+        while (!reader.Empty() && reader.OK()) {
+            Entry entry;
+            entry.key = std::string{reader.ReadLengthPrefixed()};
+            entry.pos = static_cast<std::streamoff>(reader.Read<std::uint64_t>());
+            entry.expireAtMs = reader.Read<std::uint64_t>();
+            if (reader.OK())
+                entries.emplace_back(std::move(entry));
+        }
+        return entries;
+    }
+
+    void KeySegment::VisitBlocks(std::size_t blockIdx, bool reverse,
+                                 const std::function<bool(const Entry&, std::uint64_t)>& fn) const {
+        for (auto i = blockIdx; i < mBlocks_.size(); reverse ? --i : ++i) {
+            auto entries = ReadBlock(i);
+            for (std::size_t j = 0; j < entries.size(); ++j) {
+                auto idx = reverse ? (entries.size() - 1 - j) : j;
+                if (!fn(entries[idx], mBlocks_[i].firstOrdinal + idx))
+                    return;
+            }
+            if (reverse && (0 == i)) return;
+        }
+    }
+
+    bool KeySegment::MayContain(const std::string& key) const {
+        if (mBlocks_.empty()) return false;
+        auto blockIdx = FindBlock(key);
+        if (key < mBlocks_[blockIdx].firstKey) return false;
+        return BlockMayContain(blockIdx, key);
+    }
+
+    std::optional<KeySegment::Entry> KeySegment::Find(const std::string& key) const {
+        if (!MayContain(key)) return std::nullopt;
+
+        auto entries = ReadBlock(FindBlock(key));
+        auto it = std::lower_bound(entries.begin(), entries.end(), key,
+                                   [](const Entry& e, const std::string& k) { return e.key < k; });
+        if ((it == entries.end()) || (it->key != key)) return std::nullopt;
+        return std::move(*it);
+    }
+
+    void KeySegment::ForEach(const Visitor& visitor) const {
+        if (mBlocks_.empty()) return;
+        VisitBlocks(0, false, [&visitor](const Entry& entry, std::uint64_t) { return visitor(entry); });
+    }
+
+    void KeySegment::ForEachWithPrefix(const std::string& prefix, const Visitor& visitor) const {
+        if (mBlocks_.empty()) return;
+        VisitBlocks(FindBlock(prefix), false, [&](const Entry& entry, std::uint64_t) {
+            if (entry.key < prefix) return true;
+            if (!entry.key.starts_with(prefix)) return false;
+            return visitor(entry);
+        });
+    }
+
+    void KeySegment::ForEachInRange(const std::string& start, const std::string& end, bool reverse,
+                                    const Visitor& visitor) const {
+        if (mBlocks_.empty() || (start > end)) return;
+        if (!reverse) {
+            VisitBlocks(FindBlock(start), false, [&](const Entry& entry, std::uint64_t) {
+                if (entry.key < start) return true;
+                if (entry.key > end) return false;
+                return visitor(entry);
+            });
+        } else {
+            VisitBlocks(FindBlock(end), true, [&](const Entry& entry, std::uint64_t) {
+                if (entry.key > end) return true;
+                if (entry.key < start) return false;
+                return visitor(entry);
+            });
+        }
+    }
+
+    std::uint64_t KeySegment::Scan(const std::string& prefix, std::uint64_t ordinal, std::size_t count,
+                                   const Visitor& visitor) const {
+        if (mBlocks_.empty()) return 0;
+
+        std::uint64_t nextOrdinal = 0;
+        std::size_t visited = 0;
+        VisitBlocks(std::max(FindBlock(prefix), FindBlockByOrdinal(ordinal)), false,
+                    [&](const Entry& entry, std::uint64_t entryOrdinal) {
+                        if ((entryOrdinal < ordinal) || (entry.key < prefix)) return true;
+                        if (!entry.key.starts_with(prefix)) return false;
+                        if (visited == count) {
+                            nextOrdinal = entryOrdinal;
+                            return false;
+                        }
+                        ++visited;
+                        if (!visitor(entry)) {
+                            nextOrdinal = entryOrdinal + 1;
+                            return false;
+                        }
+                        return true;
+                    });
+        return nextOrdinal;
+    }
+}// namespace foxbatdb
@@ -0,0 +1,82 @@
+#pragma once
+#include "log/datalog.h"
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace foxbatdb {
+    // 磁盘索引段：合并数据文件时生成的有序key文件，按块存储(key, 记录偏移量, 过期时间)，
+    // 内存中只保留每块的首个key（稀疏索引）与每块的布隆过滤器
+    class KeySegment {
+    public:
+        struct Entry {
+            std::string key;
+            DataLogFile::OffsetType pos = -1;// 记录在数据文件中的偏移量
+            std::uint64_t expireAtMs = 0;    // 0表示未设置过期时间
+        };
+        using Visitor = std::function<bool(const Entry& entry)>;// 返回false时终止遍历
+
+    private:
+        struct Block {
+            std::string firstKey;
+            std::uint64_t offset;
+            std::uint32_t size;
+            std::uint32_t crc;
+            std::uint64_t firstOrdinal;// 块内首个条目在整个段中的序号
+            std::vector<std::uint64_t> filter;
+        };
+
+        mutable std::mutex mt_;
+        std::string mPath_;
+        mutable std::ifstream mFile_;
+        DataLogFile* mDataFile_;
+        std::vector<Block> mBlocks_;
+        std::uint64_t mEntryNum_ = 0;
+
+        KeySegment(std::string path, DataLogFile* dataFile);
+
+        [[nodiscard]] std::size_t FindBlock(const std::string& key) const;
+        [[nodiscard]] std::size_t FindBlockByOrdinal(std::uint64_t ordinal) const;
+        [[nodiscard]] bool BlockMayContain(std::size_t blockIdx, const std::string& key) const;
+        [[nodiscard]] std::vector<Entry> ReadBlock(std::size_t blockIdx) const;
+        // 自第blockIdx块起正序或逆序遍历，fn(entry, ordinal)返回false时终止
+        void VisitBlocks(std::size_t blockIdx, bool reverse,
+                         const std::function<bool(const Entry&, std::uint64_t)>& fn) const;
+
+    public:
+        KeySegment(const KeySegment&) = delete;
+        KeySegment& operator=(const KeySegment&) = delete;
+        ~KeySegment() = default;
+
+        static std::string PathOf(std::uint8_t dbIdx);
+        // entries须按key升序排列
+        static std::unique_ptr<KeySegment> Create(const std::string& path, DataLogFile* dataFile,
+                                                  const std::vector<Entry>& entries);
+        static std::unique_ptr<KeySegment> Open(const std::string& path, DataLogFile* dataFile);
+
+        // 清单文件记录各索引段对应的数据文件大小，用于重启时判断索引段是否仍与数据文件匹配
+        static bool WriteManifest(std::uint64_t dataFileSize, std::size_t dbNum);
+        static bool ValidateManifest(std::uint64_t dataFileSize, std::size_t dbNum);
+        static void RemoveManifest();
+
+        void Rename(const std::string& newPath);
+
+        [[nodiscard]] DataLogFile* DataFile() const;
+        [[nodiscard]] std::uint64_t Size() const;
+
+        [[nodiscard]] bool MayContain(const std::string& key) const;
+        [[nodiscard]] std::optional<Entry> Find(const std::string& key) const;
+        void ForEach(const Visitor& visitor) const;
+        void ForEachWithPrefix(const std::string& prefix, const Visitor& visitor) const;
+        void ForEachInRange(const std::string& start, const std::string& end, bool reverse,
+                            const Visitor& visitor) const;
+        // 自序号ordinal起遍历前缀范围内至多count个条目，返回下一个序号，0表示遍历结束
+        std::uint64_t Scan(const std::string& prefix, std::uint64_t ordinal, std::size_t count,
+                           const Visitor& visitor) const;
+    };
+}// namespace foxbatdb
@@ -3,19 +3,36 @@
 #include "flag/flags.h"
 
 namespace foxbatdb {
+    std::unique_ptr<MaxMemoryStrategy> CreateMaxMemoryStrategy() {
+        switch (Flags::GetInstance().maxMemoryPolicy) {
+            case MaxMemoryPolicyEnum::eLRU:
+                return std::make_unique<LRUStrategy>();
+            case MaxMemoryPolicyEnum::eVolatileLRU:
+                return std::make_unique<VolatileLRUStrategy>();
+            case MaxMemoryPolicyEnum::eVolatileTTL:
+                return std::make_unique<VolatileTTLStrategy>();
+            case MaxMemoryPolicyEnum::eVolatileRandom:
+                return std::make_unique<VolatileRandomStrategy>();
+            case MaxMemoryPolicyEnum::eNoeviction:
+            default:
+                return std::make_unique<NoevictionStrategy>();
+        }
+    }
+
     void NoevictionStrategy::UpdateStateForReadOp(const std::string&) {}
-    void NoevictionStrategy::UpdateStateForWriteOp(const std::string&) {}
-    bool NoevictionStrategy::ReleaseKey(MemoryIndex*) { return false; }
+    void NoevictionStrategy::UpdateStateForWriteOp(const std::string&, const RecordObject&) {}
+    void NoevictionStrategy::UpdateStateForDelOp(const std::string&) {}
+    std::optional<std::string> NoevictionStrategy::EvictKey() { return std::nullopt; }
     bool NoevictionStrategy::HaveMemoryAvailable() const { return false; }
 
     void LRUStrategy::Update(const std::string& key) const {
+        InternedKey internedKey{key};
         std::unique_lock l{mt_};
-        if (queryMap.contains(key)) {
-            lruList.splice(lruList.end(), lruList,
-                           queryMap.at(key));
+        if (auto it = queryMap.find(internedKey); it != queryMap.end()) {
+            lruList.splice(lruList.end(), lruList, it->second);
         } else {
-            lruList.push_back(key);
-            queryMap[key] = std::prev(lruList.end());
+            lruList.push_back(internedKey);
+            queryMap.emplace(std::move(internedKey), std::prev(lruList.end()));
         }
     }
 
@@ -23,19 +40,29 @@ namespace foxbatdb {
         Update(key);
     }
 
-    void LRUStrategy::UpdateStateForWriteOp(const std::string& key) {
+    void LRUStrategy::UpdateStateForWriteOp(const std::string& key, const RecordObject&) {
         Update(key);
     }
 
-    bool LRUStrategy::ReleaseKey(MemoryIndex* engine) {
+    void LRUStrategy::UpdateStateForDelOp(const std::string& key) {
+        auto internedKey = InternedKey::Find(key);
+        if (internedKey.Empty()) return;
+
         std::unique_lock l{mt_};
-        auto& key = lruList.back();
-        if (engine->Del(key)) {
-            return false;
+        if (auto it = queryMap.find(internedKey); it != queryMap.end()) {
+            lruList.erase(it->second);
+            queryMap.erase(it);
         }
-        lruList.pop_back();
-        queryMap.erase(key);
-        return true;
+    }
+
+    std::optional<std::string> LRUStrategy::EvictKey() {
+        std::unique_lock l{mt_};
+        if (lruList.empty()) return std::nullopt;
+
+        auto internedKey = std::move(lruList.front());// ͷΪδʵkey
+        lruList.pop_front();
+        queryMap.erase(internedKey);
+        return internedKey.ToString();
     }
 
     bool LRUStrategy::HaveMemoryAvailable() const {
@@ -45,6 +72,159 @@ namespace foxbatdb {
         return true;
     }
 
+    void VolatileLRUStrategy::Remove(const InternedKey& key) {
+        if (auto it = queryMap.find(key); it != queryMap.end()) {
+            lruList.erase(it->second);
+            queryMap.erase(it);
+        }
+    }
+
+    void VolatileLRUStrategy::UpdateStateForReadOp(const std::string& key) {
+        auto internedKey = InternedKey::Find(key);
+        if (internedKey.Empty()) return;
+
+        std::unique_lock l{mt_};
+        if (auto it = queryMap.find(internedKey); it != queryMap.end()) {
+            lruList.splice(lruList.end(), lruList, it->second);
+        }
+    }
+
+    void VolatileLRUStrategy::UpdateStateForWriteOp(const std::string& key, const RecordObject& obj) {
+        InternedKey internedKey{key};
+        std::unique_lock l{mt_};
+        if (!obj.HasExpiration()) {
+            Remove(internedKey);// дΪ־key
+            return;
+        }
+
+        if (auto it = queryMap.find(internedKey); it != queryMap.end()) {
+            lruList.splice(lruList.end(), lruList, it->second);
+        } else {
+            lruList.push_back(internedKey);
+            queryMap.emplace(std::move(internedKey), std::prev(lruList.end()));
+        }
+    }
+
+    void VolatileLRUStrategy::UpdateStateForDelOp(const std::string& key) {
+        auto internedKey = InternedKey::Find(key);
+        if (internedKey.Empty()) return;
+
+        std::unique_lock l{mt_};
+        Remove(internedKey);
+    }
+
+    std::optional<std::string> VolatileLRUStrategy::EvictKey() {
+        std::unique_lock l{mt_};
+        if (lruList.empty()) return std::nullopt;
+
+        auto internedKey = std::move(lruList.front());
+        lruList.pop_front();
+        queryMap.erase(internedKey);
+        return internedKey.ToString();
+    }
+
+    bool VolatileLRUStrategy::HaveMemoryAvailable() const {
+        std::unique_lock l{mt_};
+        return !lruList.empty();
+    }
+
+    void VolatileTTLStrategy::Remove(const InternedKey& key) {
+        if (auto it = queryMap.find(key); it != queryMap.end()) {
+            expireQueue.erase({it->second, key});
+            queryMap.erase(it);
+        }
+    }
+
+    void VolatileTTLStrategy::UpdateStateForReadOp(const std::string&) {}
+
+    void VolatileTTLStrategy::UpdateStateForWriteOp(const std::string& key, const RecordObject& obj) {
+        InternedKey internedKey{key};
+        std::unique_lock l{mt_};
+        Remove(internedKey);
+        if (!obj.HasExpiration()) return;
+
+        auto expireAt = obj.GetExpirationTimePoint();
+        expireQueue.emplace(expireAt, internedKey);
+        queryMap.emplace(std::move(internedKey), expireAt);
+    }
+
+    void VolatileTTLStrategy::UpdateStateForDelOp(const std::string& key) {
+        auto internedKey = InternedKey::Find(key);
+        if (internedKey.Empty()) return;
+
+        std::unique_lock l{mt_};
+        Remove(internedKey);
+    }
+
+    std::optional<std::string> VolatileTTLStrategy::EvictKey() {
+        std::unique_lock l{mt_};
+        if (expireQueue.empty()) return std::nullopt;
+
+        // ̭ʣʱ̵key
+        auto internedKey = expireQueue.begin()->second;
+        expireQueue.erase(expireQueue.begin());
+        queryMap.erase(internedKey);
+        return internedKey.ToString();
+    }
+
+    bool VolatileTTLStrategy::HaveMemoryAvailable() const {
+        std::unique_lock l{mt_};
+        return !expireQueue.empty();
+    }
+
+    void VolatileRandomStrategy::Remove(const InternedKey& key) {
+        auto it = queryMap.find(key);
+        if (it == queryMap.end()) return;
+
+        // βԪؽ󵯳֤O(1)ɾ
+        auto idx = it->second;
+        queryMap.erase(it);
+        if (idx != keyList.size() - 1) {
+            keyList[idx] = std::move(keyList.back());
+            queryMap[keyList[idx]] = idx;
+        }
+        keyList.pop_back();
+    }
+
+    void VolatileRandomStrategy::UpdateStateForReadOp(const std::string&) {}
+
+    void VolatileRandomStrategy::UpdateStateForWriteOp(const std::string& key, const RecordObject& obj) {
+        InternedKey internedKey{key};
+        std::unique_lock l{mt_};
+        if (!obj.HasExpiration()) {
+            Remove(internedKey);
+            return;
+        }
+
+        if (!queryMap.contains(internedKey)) {
+            queryMap.emplace(internedKey, keyList.size());
+            keyList.emplace_back(std::move(internedKey));
+        }
+    }
+
+    void VolatileRandomStrategy::UpdateStateForDelOp(const std::string& key) {
+        auto internedKey = InternedKey::Find(key);
+        if (internedKey.Empty()) return;
+
+        std::unique_lock l{mt_};
+        Remove(internedKey);
+    }
+
+    std::optional<std::string> VolatileRandomStrategy::EvictKey() {
+        std::unique_lock l{mt_};
+        if (keyList.empty()) return std::nullopt;
+
+        std::uniform_int_distribution<std::size_t> dist{0, keyList.size() - 1};
+        auto internedKey = keyList[dist(randomEngine)];
+        Remove(internedKey);
+        return internedKey.ToString();
+    }
+
+    bool VolatileRandomStrategy::HaveMemoryAvailable() const {
+        std::unique_lock l{mt_};
+        return !keyList.empty();
+    }
+
     RecordObjectPool::RecordObjectPool()
         : mMemoryPoolBuf_{},
           mMemoryPool_{mMemoryPoolBuf_.data(), mMemoryPoolBuf_.size()},
@@ -1,16 +1,22 @@
 #pragma once
+#include "keypool.h"
 #include "utils/utils.h"
 #include <array>
+#include <chrono>
 #include <deque>
 #include <list>
 #include <memory>
 #include <memory_resource>
 #include <mutex>
+#include <optional>
+#include <random>
+#include <set>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace foxbatdb {
-    class MemoryIndex;
+    class RecordObject;
 
     class MaxMemoryStrategy {
     public:
@@ -18,8 +24,9 @@ namespace foxbatdb {
         virtual ~MaxMemoryStrategy() = default;
 
         virtual void UpdateStateForReadOp(const std::string& key) = 0;
-        virtual void UpdateStateForWriteOp(const std::string& key) = 0;
-        virtual bool ReleaseKey(MemoryIndex* engine) = 0;
+        virtual void UpdateStateForWriteOp(const std::string& key, const RecordObject& obj) = 0;
+        virtual void UpdateStateForDelOp(const std::string& key) = 0;
+        virtual std::optional<std::string> EvictKey() = 0;// 从策略状态中移除并返回待淘汰的key，由调用方负责删除
         [[nodiscard]] virtual bool HaveMemoryAvailable() const = 0;
 
     protected:
@@ -30,27 +37,81 @@ namespace foxbatdb {
     public:
         using MaxMemoryStrategy::MaxMemoryStrategy;
         void UpdateStateForReadOp(const std::string&) override;
-        void UpdateStateForWriteOp(const std::string&) override;
-        bool ReleaseKey(MemoryIndex*) override;
+        void UpdateStateForWriteOp(const std::string&, const RecordObject&) override;
+        void UpdateStateForDelOp(const std::string&) override;
+        std::optional<std::string> EvictKey() override;
         [[nodiscard]] bool HaveMemoryAvailable() const override;
     };
 
     class LRUStrategy : public MaxMemoryStrategy {
     private:
-        mutable std::list<std::string> lruList;
-        mutable std::unordered_map<std::string, std::list<std::string>::iterator> queryMap;
+        mutable std::list<InternedKey> lruList;
+        mutable std::unordered_map<InternedKey, std::list<InternedKey>::iterator, InternedKey::Hash> queryMap;
 
         void Update(const std::string& key) const;
 
     public:
         using MaxMemoryStrategy::MaxMemoryStrategy;
         void UpdateStateForReadOp(const std::string& key) override;
-        void UpdateStateForWriteOp(const std::string& key) override;
-        bool ReleaseKey(MemoryIndex* engine) override;
+        void UpdateStateForWriteOp(const std::string& key, const RecordObject& obj) override;
+        void UpdateStateForDelOp(const std::string& key) override;
+        std::optional<std::string> EvictKey() override;
         bool HaveMemoryAvailable() const override;
     };
 
-    class RecordObject;
+    // volatile-*策略只跟踪设置了过期时间的key，淘汰时不会触及持久key
+    class VolatileLRUStrategy : public MaxMemoryStrategy {
+    private:
+        std::list<InternedKey> lruList;
+        std::unordered_map<InternedKey, std::list<InternedKey>::iterator, InternedKey::Hash> queryMap;
+
+        void Remove(const InternedKey& key);
+
+    public:
+        using MaxMemoryStrategy::MaxMemoryStrategy;
+        void UpdateStateForReadOp(const std::string& key) override;
+        void UpdateStateForWriteOp(const std::string& key, const RecordObject& obj) override;
+        void UpdateStateForDelOp(const std::string& key) override;
+        std::optional<std::string> EvictKey() override;
+        bool HaveMemoryAvailable() const override;
+    };
+
+    class VolatileTTLStrategy : public MaxMemoryStrategy {
+    private:
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        std::set<std::pair<TimePoint, InternedKey>> expireQueue;// 按过期时间升序
+        std::unordered_map<InternedKey, TimePoint, InternedKey::Hash> queryMap;
+
+        void Remove(const InternedKey& key);
+
+    public:
+        using MaxMemoryStrategy::MaxMemoryStrategy;
+        void UpdateStateForReadOp(const std::string&) override;
+        void UpdateStateForWriteOp(const std::string& key, const RecordObject& obj) override;
+        void UpdateStateForDelOp(const std::string& key) override;
+        std::optional<std::string> EvictKey() override;
+        bool HaveMemoryAvailable() const override;
+    };
+
+    class VolatileRandomStrategy : public MaxMemoryStrategy {
+    private:
+        std::vector<InternedKey> keyList;
+        std::unordered_map<InternedKey, std::size_t, InternedKey::Hash> queryMap;
+        std::mt19937_64 randomEngine{std::random_device{}()};
+
+        void Remove(const InternedKey& key);
+
+    public:
+        using MaxMemoryStrategy::MaxMemoryStrategy;
+        void UpdateStateForReadOp(const std::string&) override;
+        void UpdateStateForWriteOp(const std::string& key, const RecordObject& obj) override;
+        void UpdateStateForDelOp(const std::string& key) override;
+        std::optional<std::string> EvictKey() override;
+        bool HaveMemoryAvailable() const override;
+    };
+
+    std::unique_ptr<MaxMemoryStrategy> CreateMaxMemoryStrategy();
     struct RecordObjectMeta;
 
     using namespace utils;
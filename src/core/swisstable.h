@@ -0,0 +1,224 @@
+#pragma once
+#include "keyarena.h"
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define FOXBATDB_SWISS_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace foxbatdb {
+    // Swiss table风格的开放寻址哈希表
+    // 每16个槽位为一组，每个槽位对应1字节控制字节（空/已删除/哈希值低7位），
+    // 查找时用SIMD一次比较整组控制字节，仅对匹配的槽位比较key
+    template<typename T>
+    class SwissTable {
+    private:
+        static constexpr std::size_t GROUP_SIZE = 16;
+        static constexpr std::int8_t CTRL_EMPTY = -128;// 0b10000000
+        static constexpr std::int8_t CTRL_DELETED = -2;// 0b11111110
+
+        struct Slot {
+            std::string_view key;// 指向mArena_
+            T value;
+        };
+
+        std::unique_ptr<std::int8_t[]> mCtrl_;
+        std::unique_ptr<Slot[]> mSlots_;
+        std::size_t mGroupNum_ = 0;
+        std::size_t mSize_ = 0;
+        std::size_t mDeleted_ = 0;
+        KeyArena mArena_;
+
+        static std::size_t Hash(std::string_view key) {
+            return std::hash<std::string_view>{}(key);
+        }
+        static std::int8_t H2(std::size_t hash) { return static_cast<std::int8_t>(hash & 0x7F); }
+        static std::size_t H1(std::size_t hash) { return hash >> 7; }
+
+        // 组内控制字节等于ctrl的槽位掩码
+        static std::uint32_t MatchMask(const std::int8_t* group, std::int8_t ctrl) {
+#ifdef FOXBATDB_SWISS_USE_SSE2
+            auto cmp = _mm_cmpeq_epi8(_mm_set1_epi8(ctrl), _mm_loadu_si128(reinterpret_cast<const __m128i*>(group)));
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(cmp));
+#else
+            std::uint32_t mask = 0;
+            for (std::size_t i = 0; i < GROUP_SIZE; ++i) {
+                if (group[i] == ctrl) mask |= (1u << i);
+            }
+            return mask;
+#endif
+        }
+
+        // 组内空闲（空或已删除）槽位掩码，二者最高位均为1
+        static std::uint32_t FreeMask(const std::int8_t* group) {
+#ifdef FOXBATDB_SWISS_USE_SSE2
+            return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group))));
+#else
+            std::uint32_t mask = 0;
+            for (std::size_t i = 0; i < GROUP_SIZE; ++i) {
+                if (group[i] < 0) mask |= (1u << i);
+            }
+            return mask;
+#endif
+        }
+
+        // 按三角数序列在组间探测，组数为2的幂时可遍历所有组
+        template<typename F>
+        bool Probe(std::size_t hash, F&& f) const {
+            auto mask = mGroupNum_ - 1;
+            auto group = H1(hash) & mask;
+            for (std::size_t i = 0; i < mGroupNum_; ++i) {
+                if (!f(group)) return true;
+                group = (group + i + 1) & mask;
+            }
+            return false;
+        }
+
+        // 返回槽位下标，不存在时返回-1
+        std::ptrdiff_t FindSlot(std::string_view key, std::size_t hash) const {
+            if (0 == mGroupNum_) return -1;
+
+            std::ptrdiff_t found = -1;
+            Probe(hash, [&](std::size_t group) {
+                auto* ctrl = mCtrl_.get() + group * GROUP_SIZE;
+                for (auto mask = MatchMask(ctrl, H2(hash)); mask; mask &= mask - 1) {
+                    auto idx = group * GROUP_SIZE + std::countr_zero(mask);
+                    if (mSlots_[idx].key == key) {
+                        found = static_cast<std::ptrdiff_t>(idx);
+                        return false;
+                    }
+                }
+                // 组内存在空槽位说明探测链到此为止
+                return 0 == MatchMask(ctrl, CTRL_EMPTY);
+            });
+            return found;
+        }
+
+        std::size_t FindFreeSlot(std::size_t hash) const {
+            std::size_t slot = 0;
+            Probe(hash, [&](std::size_t group) {
+                auto mask = FreeMask(mCtrl_.get() + group * GROUP_SIZE);
+                if (!mask) return true;
+                slot = group * GROUP_SIZE + std::countr_zero(mask);
+                return false;
+            });
+            return slot;
+        }
+
+        // 扩容或原地重建（清除删除标记并压缩key存储区）
+        void Rehash(std::size_t groupNum) {
+            auto oldCtrl = std::move(mCtrl_);
+            auto oldSlots = std::move(mSlots_);
+            auto oldGroupNum = mGroupNum_;
+            auto oldArena = std::move(mArena_);// 旧key在重建完成前仍需有效
+
+            mGroupNum_ = groupNum;
+            mCtrl_ = std::make_unique<std::int8_t[]>(mGroupNum_ * GROUP_SIZE);
+            std::memset(mCtrl_.get(), CTRL_EMPTY, mGroupNum_ * GROUP_SIZE);
+            mSlots_ = std::make_unique<Slot[]>(mGroupNum_ * GROUP_SIZE);
+            mArena_ = KeyArena{};
+            mDeleted_ = 0;
+
+            for (std::size_t i = 0; i < oldGroupNum * GROUP_SIZE; ++i) {
+                if (oldCtrl[i] < 0) continue;
+                auto hash = Hash(oldSlots[i].key);
+                auto slot = FindFreeSlot(hash);
+                mCtrl_[slot] = H2(hash);
+                mSlots_[slot] = Slot{.key = mArena_.Store(oldSlots[i].key), .value = std::move(oldSlots[i].value)};
+            }
+        }
+
+        void ReserveForInsert() {
+            auto capacity = mGroupNum_ * GROUP_SIZE;
+            // 最大负载因子7/8，删除标记同样占用探测链
+            if ((mSize_ + mDeleted_ + 1) * 8 <= capacity * 7) return;
+            if ((mSize_ + 1) * 16 <= capacity * 7)
+                Rehash(mGroupNum_);// 删除标记较多，原地重建即可
+            else
+                Rehash(mGroupNum_ ? mGroupNum_ * 2 : 1);
+        }
+
+    public:
+        SwissTable() = default;
+        SwissTable(const SwissTable&) = delete;
+        SwissTable& operator=(const SwissTable&) = delete;
+        SwissTable(SwissTable&&) noexcept = default;
+        SwissTable& operator=(SwissTable&&) noexcept = default;
+        ~SwissTable() = default;
+
+        [[nodiscard]] std::size_t Size() const { return mSize_; }
+        [[nodiscard]] std::size_t Capacity() const { return mGroupNum_ * GROUP_SIZE; }
+
+        [[nodiscard]] const T* Find(std::string_view key) const {
+            auto idx = FindSlot(key, Hash(key));
+            return (idx < 0) ? nullptr : &mSlots_[idx].value;
+        }
+
+        T* Find(std::string_view key) {
+            return const_cast<T*>(std::as_const(*this).Find(key));
+        }
+
+        // 返回true表示插入了新key，false表示覆盖了已有key的value
+        bool InsertOrAssign(std::string_view key, T value) {
+            auto hash = Hash(key);
+            if (auto idx = FindSlot(key, hash); idx >= 0) {
+                mSlots_[idx].value = std::move(value);
+                return false;
+            }
+
+            ReserveForInsert();
+            auto slot = FindFreeSlot(hash);
+            if (CTRL_DELETED == mCtrl_[slot]) --mDeleted_;
+            mCtrl_[slot] = H2(hash);
+            mSlots_[slot] = Slot{.key = mArena_.Store(key), .value = std::move(value)};
+            ++mSize_;
+            return true;
+        }
+
+        bool Erase(std::string_view key) {
+            auto idx = FindSlot(key, Hash(key));
+            if (idx < 0) return false;
+
+            mArena_.Release(mSlots_[idx].key);
+            mSlots_[idx] = Slot{};
+            // 所在组仍有空槽位时，探测链不会越过该组，可直接置空
+            auto* group = mCtrl_.get() + (idx / GROUP_SIZE) * GROUP_SIZE;
+            if (MatchMask(group, CTRL_EMPTY)) {
+                mCtrl_[idx] = CTRL_EMPTY;
+            } else {
+                mCtrl_[idx] = CTRL_DELETED;
+                ++mDeleted_;
+            }
+            --mSize_;
+
+            if (mArena_.NeedCompact())
+                Rehash(mGroupNum_);
+            return true;
+        }
+
+        // 按槽位顺序遍历，visitor返回false时终止
+        template<typename Visitor>
+        void ForEach(Visitor&& visitor) const {
+            ForEachFromSlot(0, visitor);
+        }
+
+        // 自槽位start起遍历，返回停止处的槽位下标，遍历完成时返回Capacity()
+        template<typename Visitor>
+        std::size_t ForEachFromSlot(std::size_t start, Visitor&& visitor) const {
+            auto capacity = Capacity();
+            for (auto i = start; i < capacity; ++i) {
+                if (mCtrl_[i] < 0) continue;
+                if (!visitor(mSlots_[i].key, mSlots_[i].value)) return i;
+            }
+            return capacity;
+        }
+    };
+}// namespace foxbatdb
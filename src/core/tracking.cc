@@ -0,0 +1,124 @@
+#include "tracking.h"
+#include "flag/flags.h"
+#include "frontend/server.h"
+#include <algorithm>
+#include <string_view>
+
+namespace foxbatdb {
+    namespace {
+        bool IsSameClient(const std::weak_ptr<CMDSession>& lhs, const std::weak_ptr<CMDSession>& rhs) {
+            return !lhs.owner_before(rhs) && !rhs.owner_before(lhs);
+        }
+    }// namespace
+
+    ClientTracking& ClientTracking::GetInstance() {
+        static ClientTracking instance;
+        return instance;
+    }
+
+    void ClientTracking::Init() {
+        mMaxKeys_ = Flags::GetInstance().trackingTableMaxKeys;
+    }
+
+    void ClientTracking::AppendClient(ClientList& list, std::weak_ptr<CMDSession> weak) {
+        // 同一连接重复读取同一key时只记录一次，顺带复用已断开连接的位置
+        for (auto& exist: list) {
+            if (IsSameClient(exist, weak)) return;
+            if (exist.expired()) {
+                exist = std::move(weak);
+                return;
+            }
+        }
+        list.emplace_back(std::move(weak));
+    }
+
+    void ClientTracking::Notify(ClientList& clients, const std::string& key) {
+        // 按连接去重：广播模式下一个连接的多个前缀可能同时匹配
+        std::vector<std::shared_ptr<CMDSession>> targets;
+        targets.reserve(clients.size());
+        for (const auto& weak: clients) {
+            if (auto clt = weak.lock(); clt && (TrackingMode::kOff != clt->GetTrackingMode()))
+                targets.emplace_back(std::move(clt));
+        }
+        std::sort(targets.begin(), targets.end());
+        targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+        for (const auto& clt: targets)
+            clt->WriteInvalidateMsg(key);
+    }
+
+    void ClientTracking::TrackKey(const std::string& key, std::weak_ptr<CMDSession> weak) {
+        std::string evictedKey;
+        ClientList evictedClients;
+        {
+            std::unique_lock l{mt_};
+            auto [it, isInserted] = mKeyMap_.try_emplace(InternedKey{key});
+            AppendClient(it->second, std::move(weak));
+            if (!isInserted) return;
+
+            mEntryNum_.fetch_add(1, std::memory_order_relaxed);
+            // 跟踪表已满时移除另一个key，并通知缓存了它的连接丢弃该key，以此限制跟踪表的内存
+            if (mMaxKeys_ && (mKeyMap_.size() > mMaxKeys_)) {
+                auto victim = (mKeyMap_.begin() != it) ? mKeyMap_.begin() : std::next(mKeyMap_.begin());
+                evictedKey = victim->first.ToString();
+                evictedClients = std::move(victim->second);
+                mKeyMap_.erase(victim);
+                mEntryNum_.fetch_sub(1, std::memory_order_relaxed);
+            }
+        }
+        if (!evictedClients.empty())
+            Notify(evictedClients, evictedKey);
+    }
+
+    void ClientTracking::TrackPrefix(const std::string& prefix, std::weak_ptr<CMDSession> weak) {
+        std::unique_lock l{mt_};
+        auto it = mPrefixMap_.find(prefix);
+        if (it == mPrefixMap_.end()) {
+            it = mPrefixMap_.insert(prefix, ClientList{}).first;
+            mEntryNum_.fetch_add(1, std::memory_order_relaxed);
+        }
+        AppendClient(it.value(), std::move(weak));
+    }
+
+    void ClientTracking::UntrackPrefix(const std::string& prefix, std::weak_ptr<CMDSession> weak) {
+        std::unique_lock l{mt_};
+        auto it = mPrefixMap_.find(prefix);
+        if (it == mPrefixMap_.end()) return;
+
+        auto& list = it.value();
+        std::erase_if(list, [&weak](const auto& exist) { return exist.expired() || IsSameClient(exist, weak); });
+        if (list.empty()) {
+            mPrefixMap_.erase(prefix);
+            mEntryNum_.fetch_sub(1, std::memory_order_relaxed);
+        }
+    }
+
+    void ClientTracking::Invalidate(const std::string& key) {
+        if (0 == mEntryNum_.load(std::memory_order_relaxed)) return;
+
+        ClientList clients;
+        {
+            std::unique_lock l{mt_};
+            // 跟踪表持有key的引用，key不在共享key池中即未被跟踪
+            if (auto internedKey = InternedKey::Find(key); !internedKey.Empty()) {
+                if (auto it = mKeyMap_.find(internedKey); it != mKeyMap_.end()) {
+                    clients = std::move(it->second);
+                    mKeyMap_.erase(it);
+                    mEntryNum_.fetch_sub(1, std::memory_order_relaxed);
+                }
+            }
+
+            // 自最长的前缀起，依次查找key的所有已订阅前缀
+            std::string_view rest = key;
+            for (auto it = mPrefixMap_.longest_prefix(rest); it != mPrefixMap_.end();
+                 it = mPrefixMap_.longest_prefix(rest)) {
+                const auto& list = it.value();
+                clients.insert(clients.end(), list.begin(), list.end());
+                auto prefixSize = it.key().size();
+                if (0 == prefixSize) break;
+                rest = rest.substr(0, prefixSize - 1);
+            }
+        }
+        if (!clients.empty())
+            Notify(clients, key);
+    }
+}// namespace foxbatdb
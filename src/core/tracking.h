@@ -0,0 +1,50 @@
+#pragma once
+#include "keypool.h"
+#include "tsl/htrie_map.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace foxbatdb {
+    class CMDSession;
+
+    enum class TrackingMode : std::uint8_t {
+        kOff = 0,
+        kKeys,     // 记录连接读取过的key，key被修改时通知读取过它的连接
+        kBroadcast,// 不记录读取，匹配所订阅前缀的key被修改时即通知
+    };
+
+    // 客户端缓存跟踪（CLIENT TRACKING）：key被修改、删除或过期时，向缓存了该key的连接推送invalidate消息；
+    // 与Redis相同，key按名字跟踪，不区分所在的数据库
+    class ClientTracking {
+    private:
+        using ClientList = std::vector<std::weak_ptr<CMDSession>>;
+
+        mutable std::mutex mt_;
+        std::unordered_map<InternedKey, ClientList, InternedKey::Hash> mKeyMap_;// 每个key只通知一次，通知后即移除
+        tsl::htrie_map<char, ClientList> mPrefixMap_;
+        std::atomic<std::size_t> mEntryNum_ = 0;// key与前缀的总数，为0时写操作无需加锁
+        std::size_t mMaxKeys_ = 0;
+
+        ClientTracking() = default;
+
+        static void AppendClient(ClientList& list, std::weak_ptr<CMDSession> weak);
+        static void Notify(ClientList& clients, const std::string& key);
+
+    public:
+        ClientTracking(const ClientTracking&) = delete;
+        ClientTracking& operator=(const ClientTracking&) = delete;
+        ~ClientTracking() = default;
+        static ClientTracking& GetInstance();
+        void Init();
+
+        void TrackKey(const std::string& key, std::weak_ptr<CMDSession> weak);
+        void TrackPrefix(const std::string& prefix, std::weak_ptr<CMDSession> weak);
+        void UntrackPrefix(const std::string& prefix, std::weak_ptr<CMDSession> weak);
+        void Invalidate(const std::string& key);
+    };
+}// namespace foxbatdb
@@ -1,7 +1,11 @@
 #include "cron.h"
+#include "core/db.h"
 #include "flag/flags.h"
+#include "log/checkpoint.h"
 #include "log/datalog.h"
 #include "log/oplog.h"
+#include "log/serverlog.h"
+#include "utils/utils.h"
 
 namespace foxbatdb {
     namespace detail {
@@ -34,10 +38,13 @@ namespace foxbatdb {
     }// namespace detail
 
     CronJobManager::CronJobManager()
-        : mIOContext_{}, mOperationLogDumpTimer_{mIOContext_}, mDataLogFileMergeTimer_{mIOContext_} {
+        : mIOContext_{}, mOperationLogDumpTimer_{mIOContext_}, mDataLogFileMergeTimer_{mIOContext_},
+          mActiveExpireTimer_{mIOContext_}, mIndexCheckpointTimer_{mIOContext_} {
         mWait_ = std::async(
                 std::launch::async,
                 [this]() -> void {
+                    if (!utils::SetCurrentThreadAffinity(Flags::GetInstance().backgroundThreadCpuAffinity))
+                        ServerLog::GetInstance().Warning("bind background thread to cpus failed");
                     this->AddJobs();
                     this->Start();
                     this->mIOContext_.run();
@@ -46,6 +53,11 @@ namespace foxbatdb {
 
     CronJobManager::~CronJobManager() {
         mOperationLogDumpTimer_.Stop();
+        mDataLogFileMergeTimer_.Stop();
+        mActiveExpireTimer_.Stop();
+        mIndexCheckpointTimer_.Stop();
+        // 不等待各定时器下次到期，正在执行的任务完成后即退出
+        mIOContext_.stop();
         mWait_.wait();
     }
 
@@ -63,6 +75,15 @@ namespace foxbatdb {
                 []() -> void {
                     DataLogFileManager::GetInstance().Merge();
                 });
+        mActiveExpireTimer_.SetTimeoutHandler(
+                []() -> void {
+                    DatabaseManager::GetInstance().ActiveExpireCycle();
+                });
+        // 与数据文件合并在同一线程执行，二者不会并发
+        mIndexCheckpointTimer_.SetTimeoutHandler(
+                []() -> void {
+                    IndexCheckpoint::GetInstance().DumpToDisk();
+                });
     }
 
     void CronJobManager::Start() {
@@ -70,6 +91,13 @@ namespace foxbatdb {
                 std::chrono::milliseconds{Flags::GetInstance().operationLogWriteCronJobPeriodMs});
         mDataLogFileMergeTimer_.Start(
                 std::chrono::milliseconds{Flags::GetInstance().dbFileMergeCronJobPeriodMs});
+        mActiveExpireTimer_.Start(
+                std::chrono::milliseconds{Flags::GetInstance().activeExpireCronJobPeriodMs});
+        // 磁盘索引模式下重启依赖磁盘索引段，不生成索引检查点
+        if ((Flags::GetInstance().indexCheckpointCronJobPeriodMs > 0) && !Flags::GetInstance().diskIndexMode) {
+            mIndexCheckpointTimer_.Start(
+                    std::chrono::milliseconds{Flags::GetInstance().indexCheckpointCronJobPeriodMs});
+        }
     }
 
     void CronJobManager::Init() {}
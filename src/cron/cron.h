@@ -32,6 +32,8 @@ namespace foxbatdb {
         std::future<void> mWait_;
         detail::RepeatedTimer mOperationLogDumpTimer_;
         detail::RepeatedTimer mDataLogFileMergeTimer_;
+        detail::RepeatedTimer mActiveExpireTimer_;
+        detail::RepeatedTimer mIndexCheckpointTimer_;
 
         CronJobManager();
         void AddJobs();
@@ -42,6 +42,15 @@ namespace foxbatdb::error {
             case RuntimeErrorCode::kInvalidValueType:
                 return "Invalid value type";
 
+            case RuntimeErrorCode::kIndexNotSupport:
+                return "Operation not supported by the index engine of current db";
+
+            case RuntimeErrorCode::kInvalidExpireTime:
+                return "Invalid expire time";
+
+            case RuntimeErrorCode::kInvalidScanCursor:
+                return "Invalid or expired scan cursor";
+
             default:
                 return "Wrong Runtime Error Code";
         }
@@ -15,7 +15,10 @@ namespace foxbatdb::error {
         kTxError,
         kWatchedKeyModified,
         kInvalidTxCmd,
-        kInvalidValueType
+        kInvalidValueType,
+        kIndexNotSupport,
+        kInvalidExpireTime,
+        kInvalidScanCursor
     };
 
     class RuntimeErrorCategory : public std::error_category {
@@ -1,5 +1,6 @@
 #include "flags.h"
 #include "toml.hpp"
+#include <algorithm>
 #include <system_error>
 #include <thread>
 #include <unordered_map>
@@ -20,11 +21,32 @@ namespace foxbatdb {
 
         this->port = tbl["startup"]["listenPort"].value<std::uint16_t>().value();
         this->dbMaxNum = tbl["startup"]["databaseNumber"].value<std::uint8_t>().value();
-        this->threadNum = tbl["startup"]["threadNum"].value<std::size_t>().value();
+        // threadNum为auto或0时按CPU核数确定IO线程数
+        if (tbl["startup"]["threadNum"].value<std::string>() == "auto") {
+            this->threadNum = 0;
+        } else {
+            this->threadNum = tbl["startup"]["threadNum"].value<std::size_t>().value();
+        }
         this->serverLogPath = tbl["startup"]["serverLogPath"].value<std::string>().value();
         this->serverLogMaxFileSize = tbl["startup"]["serverLogMaxFileSizeMB"].value<std::uint64_t>().value();
         this->serverLogMaxFileNumber = tbl["startup"]["serverLogMaxFileNumber"].value<std::uint64_t>().value();
         this->serverLogFlushPeriodSec = tbl["startup"]["serverLogFlushPeriodSec"].value<std::int64_t>().value();
+        this->reusePort = tbl["startup"]["reusePort"].value_or(false);
+        this->unixSocketPath = tbl["startup"]["unixSocketPath"].value_or(std::string{});
+        this->trackingTableMaxKeys = tbl["startup"]["trackingTableMaxKeys"].value_or<std::size_t>(1000000);
+        {
+            auto toCpuList = [](const toml::array* arr) {
+                std::vector<std::size_t> cpus;
+                if (arr) {
+                    for (auto&& cpu: *arr)
+                        cpus.emplace_back(cpu.value<std::size_t>().value());
+                }
+                return cpus;
+            };
+            this->ioThreadCpuAffinity = toCpuList(tbl["startup"]["ioThreadCpuAffinity"].as_array());
+            this->backgroundThreadCpuAffinity = toCpuList(tbl["startup"]["backgroundThreadCpuAffinity"].as_array());
+        }
+        this->clientOutputBufferLimit = tbl["startup"]["clientOutputBufferLimitMB"].value_or<std::uint64_t>(32);
 
         this->operationLogWriteCronJobPeriodMs = tbl["aof"]["aofCronJobPeriodMs"].value<std::int64_t>().value();
         this->operationLogFileName = tbl["aof"]["aofLogFilePath"].value<std::string>().value();
@@ -33,14 +55,24 @@ namespace foxbatdb {
         this->dbLogFileMaxSize = tbl["dbfile"]["dbFileMaxSizeMB"].value<std::uint64_t>().value();
         this->dbFileMergeThreshold = tbl["dbfile"]["dbFileMergeThreshold"].value<std::uint16_t>().value();
         this->dbFileMergeCronJobPeriodMs = tbl["dbfile"]["dbFileMergeCronJobPeriodMs"].value<std::int64_t>().value();
+        this->indexCheckpointCronJobPeriodMs = tbl["dbfile"]["indexCheckpointCronJobPeriodMs"].value_or<std::int64_t>(0);
+        this->diskIndexMode = tbl["dbfile"]["diskIndexMode"].value_or(false);
+        this->storageThreadNum = tbl["dbfile"]["storageThreadNum"].value_or<std::size_t>(4);
+        this->storageQueueSize = tbl["dbfile"]["storageQueueSize"].value_or<std::size_t>(1024);
 
         this->keyMaxBytes = tbl["keyval"]["keyMaxBytes"].value<std::uint32_t>().value();
         this->valMaxBytes = tbl["keyval"]["valueMaxBytes"].value<std::uint32_t>().value();
 
+        this->activeExpireCronJobPeriodMs = tbl["expire"]["activeExpireCronJobPeriodMs"].value<std::int64_t>().value();
+        this->activeExpireCycleBudgetUs = tbl["expire"]["activeExpireCycleBudgetUs"].value<std::int64_t>().value();
+
         {
             static const std::unordered_map<std::string, MaxMemoryPolicyEnum> maxMemoryPolicyMap{
                     {"noeviction", MaxMemoryPolicyEnum::eNoeviction},
-                    {"allkeys-lru", MaxMemoryPolicyEnum::eLRU}};
+                    {"allkeys-lru", MaxMemoryPolicyEnum::eLRU},
+                    {"volatile-lru", MaxMemoryPolicyEnum::eVolatileLRU},
+                    {"volatile-ttl", MaxMemoryPolicyEnum::eVolatileTTL},
+                    {"volatile-random", MaxMemoryPolicyEnum::eVolatileRandom}};
 
             auto maxMemoryPolicyStr = tbl["memory"]["maxmemoryPolicy"].value<std::string>().value();
             if (!maxMemoryPolicyMap.contains(maxMemoryPolicyStr))
@@ -50,11 +82,37 @@ namespace foxbatdb {
         }
 
         this->memoryPoolMinSize = tbl["memory"]["memoryPoolMinSize"].value<std::size_t>().value();
+
+        {
+            static const std::unordered_map<std::string, IndexEngineEnum> indexEngineMap{
+                    {"hat-trie", IndexEngineEnum::eHATTrie},
+                    {"ordered", IndexEngineEnum::eOrdered},
+                    {"art", IndexEngineEnum::eART},
+                    {"hash", IndexEngineEnum::eHash}};
+
+            auto toIndexEngine = [](const std::string& name) {
+                if (!indexEngineMap.contains(name))
+                    throw std::runtime_error{"invalid index engine config: " + name};
+                return indexEngineMap.at(name);
+            };
+
+            auto defaultEngine = toIndexEngine(tbl["index"]["defaultEngine"].value_or<std::string>("hat-trie"));
+            this->dbIndexEngine.assign(this->dbMaxNum, defaultEngine);
+
+            // 按db编号依次指定索引引擎，未指定的db使用默认引擎
+            if (auto* engines = tbl["index"]["dbEngines"].as_array(); engines) {
+                std::size_t dbIdx = 0;
+                for (auto&& engine: *engines) {
+                    if (dbIdx >= this->dbIndexEngine.size()) break;
+                    this->dbIndexEngine[dbIdx++] = toIndexEngine(engine.value<std::string>().value());
+                }
+            }
+        }
     }
 
     void Flags::Preprocess() {
         if (0 == threadNum) {
-            threadNum = std::thread::hardware_concurrency();
+            threadNum = std::max(1U, std::thread::hardware_concurrency());
         }
 
         if (dbFileMergeThreshold < 2) {
@@ -62,6 +120,7 @@ namespace foxbatdb {
         }
 
         serverLogMaxFileSize = serverLogMaxFileSize * 1024 * 1024;
+        clientOutputBufferLimit = clientOutputBufferLimit * 1024 * 1024;
 
         if (dbLogFileDir.back() == '/') {
             dbLogFileDir.pop_back();
@@ -1,11 +1,22 @@
 #pragma once
 #include <cstdint>
 #include <string>
+#include <vector>
 
 namespace foxbatdb {
     enum class MaxMemoryPolicyEnum : std::uint8_t {
         eNoeviction = 1,
-        eLRU
+        eLRU,
+        eVolatileLRU,
+        eVolatileTTL,
+        eVolatileRandom
+    };
+
+    enum class IndexEngineEnum : std::uint8_t {
+        eHATTrie = 1,
+        eOrdered,
+        eART,
+        eHash
     };
 
     struct Flags {
@@ -24,8 +35,21 @@ namespace foxbatdb {
         MaxMemoryPolicyEnum maxMemoryPolicy;
         std::size_t memoryPoolMinSize;
         std::size_t threadNum;
+        std::vector<std::size_t> ioThreadCpuAffinity;        // 第i个IO线程绑定到第i%n个CPU，为空时不绑定
+        std::vector<std::size_t> backgroundThreadCpuAffinity;// 后台定时任务线程（合并、落盘、过期清理）可运行的CPU
+        bool reusePort;// 每个IO线程各自监听端口，由内核均衡分发新连接
+        std::string unixSocketPath;// Unix域socket监听路径，为空表示不监听
+        std::size_t trackingTableMaxKeys;// 客户端缓存跟踪表最多记录的key数，0表示不限制
+        std::uint64_t clientOutputBufferLimit;// 订阅消息积压超过该字节数时断开连接，0表示不限制
         std::int64_t dbFileMergeCronJobPeriodMs;
+        std::int64_t indexCheckpointCronJobPeriodMs;// 0表示不生成索引检查点
+        bool diskIndexMode;                         // 合并时将冷key移出内存，写入磁盘索引段
+        std::size_t storageThreadNum;// 执行需读取数据文件的命令的工作线程数，0表示在IO线程上直接执行
+        std::size_t storageQueueSize;// 存储线程池的任务队列上限，队列满时命令在IO线程上直接执行
         std::uint16_t dbFileMergeThreshold;
+        std::int64_t activeExpireCronJobPeriodMs;
+        std::int64_t activeExpireCycleBudgetUs;
+        std::vector<IndexEngineEnum> dbIndexEngine;// 下标为db编号
 
         Flags(const Flags&) = delete;
         Flags& operator=(const Flags&) = delete;
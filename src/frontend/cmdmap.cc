@@ -1,29 +1,60 @@
 #include "cmdmap.h"
 #include "errors/protocol.h"
+#include <cstring>
 
 std::error_code foxbatdb::Command::Validate() const {
     // УǷȷ
-    auto& mainCmdWrapper = MainCommandMap.at(this->name);
-    if ((this->argv.size() < mainCmdWrapper.minArgc) ||
-        (this->argv.size() > mainCmdWrapper.maxArgc)) {
+    const auto* mainCmdWrapper = FindMainCommand(this->name);
+    if (!mainCmdWrapper)
+        return error::ProtocolErrorCode::kCommandNotFound;
+    if ((this->argv.size() < mainCmdWrapper->minArgc) ||
+        (this->argv.size() > mainCmdWrapper->maxArgc)) {
         return error::ProtocolErrorCode::kArgNumbers;
     }
     // Уѡ
-    auto& opts = this->options;
-    for (const auto& opt: opts) {
-        auto& cmdOptWrapper = CommandOptionMap.at(opt.name);
+    std::uint16_t optMask = 0;
+    for (const auto& opt: this->options)
+        optMask |= detail::CommandOptionMask({opt.type});
+
+    for (const auto& opt: this->options) {
+        const auto* cmdOptWrapper = FindCommandOption(opt.name);
+        if (!cmdOptWrapper)
+            return error::ProtocolErrorCode::kSyntax;
         // УѡǷڻ
-        for (auto optType: cmdOptWrapper.exclusiveOpts) {
-            if (opts.end() != std::find_if(opts.begin(), opts.end(),
-                                           [optType](const CommandOption& o) { return o.type == optType; })) {
-                return error::ProtocolErrorCode::kOptionExclusive;
-            }
+        if (cmdOptWrapper->exclusiveOpts & optMask) {
+            return error::ProtocolErrorCode::kOptionExclusive;
         }
         // УѡǷȷ
-        if ((opt.argv.size() < cmdOptWrapper.minArgc) ||
-            (opt.argv.size() > cmdOptWrapper.maxArgc)) {
+        if ((opt.argv.size() < cmdOptWrapper->minArgc) ||
+            (opt.argv.size() > cmdOptWrapper->maxArgc)) {
             return error::ProtocolErrorCode::kArgNumbers;
         }
     }
     return error::ProtocolErrorCode::kSuccess;
 }
+
+foxbatdb::Command foxbatdb::Command::CopyTo(std::pmr::memory_resource* resource) const {
+    auto copy = [resource](std::string_view str) -> std::string_view {
+        if (str.empty()) return {};
+        auto* data = static_cast<char*>(resource->allocate(str.size(), alignof(char)));
+        std::memcpy(data, str.data(), str.size());
+        return {data, str.size()};
+    };
+
+    Command ret{resource};
+    ret.name = this->name;
+    ret.call = this->call;
+    ret.argv.reserve(this->argv.size());
+    for (auto arg: this->argv)
+        ret.argv.emplace_back(copy(arg));
+
+    ret.options.reserve(this->options.size());
+    for (const auto& opt: this->options) {
+        CommandOption optCopy{.name = opt.name, .type = opt.type, .argv = std::pmr::vector<std::string_view>{resource}};
+        optCopy.argv.reserve(opt.argv.size());
+        for (auto arg: opt.argv)
+            optCopy.argv.emplace_back(copy(arg));
+        ret.options.emplace_back(std::move(optCopy));
+    }
+    return ret;
+}
@@ -1,9 +1,12 @@
 #pragma once
 #include "core/handler.h"
+#include <array>
 #include <climits>
+#include <cstdint>
+#include <initializer_list>
+#include <memory_resource>
+#include <string_view>
 #include <system_error>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 namespace foxbatdb {
@@ -13,26 +16,38 @@ namespace foxbatdb {
         kNX,
         kXX,
         kKEEPTTL,
-        kGET
+        kGET,
+        kMATCH,
+        kCOUNT,
+        kLIMIT,
+        kBCAST,
+        kPREFIX
     };
 
     struct CommandOption {
-        std::string name;
+        std::string_view name;// 指向CommandOptionTable中的选项名
         CmdOptionType type;
-        std::vector<std::string> argv;
+        std::pmr::vector<std::string_view> argv;
     };
 
     struct Command;
     class CMDSession;
     using CmdProcFunc = ProcResult (*)(std::weak_ptr<CMDSession>, const Command&);
 
+    // 参数为读缓冲区上的视图，容器分配自连接的请求内存池，仅在本次请求处理期间有效；
+    // 需跨请求保存时（如事务队列）须先调用CopyTo复制
     struct Command {
-        std::string name;
-        CmdProcFunc call;
-        std::vector<std::string> argv;
-        std::vector<CommandOption> options;
+        std::string_view name;// 指向MainCommandTable中的命令名
+        CmdProcFunc call = nullptr;
+        std::pmr::vector<std::string_view> argv;
+        std::pmr::vector<CommandOption> options;
+
+        explicit Command(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+            : argv{resource}, options{resource} {}
 
         [[nodiscard]] std::error_code Validate() const;
+        // 将参数复制到resource中，返回的命令不再引用读缓冲区
+        [[nodiscard]] Command CopyTo(std::pmr::memory_resource* resource) const;
     };
 
     namespace detail {
@@ -40,6 +55,7 @@ namespace foxbatdb {
         constexpr static std::uint8_t MAX_COMMAND_NAME_LENGTH = 32;
 
         struct MainCommandWrapper {
+            std::string_view name;
             CmdProcFunc call;
             bool isWriteCmd;
             std::uint8_t minArgc;
@@ -47,61 +63,173 @@ namespace foxbatdb {
         };
 
         struct CommandOptionWrapper {
+            std::string_view name;
             CmdOptionType type;
-            std::unordered_set<std::string> matchedMainCommand;
-            std::vector<CmdOptionType> exclusiveOpts;
+            std::uint64_t matchedMainCommand = 0;// 按MainCommandTable下标置位
+            std::uint16_t exclusiveOpts = 0;     // 按CmdOptionType取值置位
             std::uint8_t minArgc;
             std::uint8_t maxArgc;
         };
+
+        constexpr char ToLowerASCII(char c) {
+            return (('A' <= c) && (c <= 'Z')) ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        // 大小写不敏感的FNV-1a哈希
+        constexpr std::uint32_t HashCommandName(std::string_view name, std::uint32_t seed) {
+            std::uint32_t h = 2166136261U ^ seed;
+            for (char c: name) {
+                h ^= static_cast<std::uint8_t>(ToLowerASCII(c));
+                h *= 16777619U;
+            }
+            return h ^ (h >> 16);
+        }
+
+        // lowerName须为全小写
+        constexpr bool EqualsIgnoreCase(std::string_view str, std::string_view lowerName) {
+            if (str.size() != lowerName.size()) return false;
+            for (std::size_t i = 0; i < str.size(); ++i) {
+                if (ToLowerASCII(str[i]) != lowerName[i]) return false;
+            }
+            return true;
+        }
+
+        // 编译期搜索使所有名字哈希到不同槽位的种子，查找时只需计算一次哈希并比较一次名字
+        template<std::size_t SLOT_NUM>
+        struct PerfectHashIndex {
+            static constexpr std::uint8_t EMPTY_SLOT = UINT8_MAX;
+            static_assert(0 == (SLOT_NUM & (SLOT_NUM - 1)), "slot number must be a power of two");
+
+            std::uint32_t seed = 0;
+            std::array<std::uint8_t, SLOT_NUM> slots{};
+
+            template<typename Entry, std::size_t N>
+            constexpr const Entry* Find(const std::array<Entry, N>& table, std::string_view name) const {
+                if (name.size() > MAX_COMMAND_NAME_LENGTH) return nullptr;
+                auto idx = slots[HashCommandName(name, seed) & (SLOT_NUM - 1)];
+                if ((EMPTY_SLOT == idx) || !EqualsIgnoreCase(name, table[idx].name)) return nullptr;
+                return &table[idx];
+            }
+        };
+
+        template<std::size_t SLOT_NUM, typename Entry, std::size_t N>
+        constexpr PerfectHashIndex<SLOT_NUM> BuildPerfectHashIndex(const std::array<Entry, N>& table) {
+            static_assert(N < PerfectHashIndex<SLOT_NUM>::EMPTY_SLOT);
+            constexpr std::uint32_t MAX_SEED = 1U << 16;
+            for (std::uint32_t seed = 0; seed < MAX_SEED; ++seed) {
+                PerfectHashIndex<SLOT_NUM> index{.seed = seed};
+                index.slots.fill(PerfectHashIndex<SLOT_NUM>::EMPTY_SLOT);
+                bool collided = false;
+                for (std::size_t i = 0; !collided && (i < N); ++i) {
+                    auto& slot = index.slots[HashCommandName(table[i].name, seed) & (SLOT_NUM - 1)];
+                    collided = (PerfectHashIndex<SLOT_NUM>::EMPTY_SLOT != slot);
+                    slot = static_cast<std::uint8_t>(i);
+                }
+                if (!collided) return index;
+            }
+            throw "no perfect hash seed found, enlarge SLOT_NUM";// 编译期求值时即为编译错误
+        }
+    }// namespace detail
+
+    inline constexpr std::array MainCommandTable{
+            detail::MainCommandWrapper{.name = "select", .call = &SwitchDB, .isWriteCmd = true, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "hello", .call = &Hello, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "merge", .call = &Merge, .isWriteCmd = false, .minArgc = 0, .maxArgc = 0},
+            detail::MainCommandWrapper{.name = "move", .call = &Move, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2},
+            detail::MainCommandWrapper{.name = "client", .call = &Client, .isWriteCmd = false, .minArgc = 2, .maxArgc = 2},
+
+            detail::MainCommandWrapper{.name = "multi", .call = nullptr, .isWriteCmd = false, .minArgc = 0, .maxArgc = 0},
+            detail::MainCommandWrapper{.name = "discard", .call = nullptr, .isWriteCmd = false, .minArgc = 0, .maxArgc = 0},
+            detail::MainCommandWrapper{.name = "exec", .call = nullptr, .isWriteCmd = false, .minArgc = 0, .maxArgc = 0},
+            detail::MainCommandWrapper{.name = "watch", .call = &Watch, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "unwatch", .call = &UnWatch, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1},
+
+            detail::MainCommandWrapper{.name = "publish", .call = &PublishWithChannel, .isWriteCmd = false, .minArgc = 2, .maxArgc = 2},
+            detail::MainCommandWrapper{.name = "subscribe", .call = &SubscribeWithChannel, .isWriteCmd = false, .minArgc = 1, .maxArgc = detail::MAX_COMMAND_PARAM_NUMBER},
+            detail::MainCommandWrapper{.name = "unsubscribe", .call = &UnSubscribeWithChannel, .isWriteCmd = false, .minArgc = 1, .maxArgc = detail::MAX_COMMAND_PARAM_NUMBER},
+
+            detail::MainCommandWrapper{.name = "get", .call = &StrGet, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "exists", .call = &Exists, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "getrange", .call = &StrGetRange, .isWriteCmd = false, .minArgc = 3, .maxArgc = 3},
+            detail::MainCommandWrapper{.name = "mget", .call = &StrMultiGet, .isWriteCmd = false, .minArgc = 1, .maxArgc = detail::MAX_COMMAND_PARAM_NUMBER},
+            detail::MainCommandWrapper{.name = "strlen", .call = &StrLength, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "prefix", .call = &Prefix, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "scan", .call = &Scan, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "pscan", .call = &PrefixScan, .isWriteCmd = false, .minArgc = 2, .maxArgc = 2},
+            detail::MainCommandWrapper{.name = "prefixkeys", .call = &PrefixKeys, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "prefixcount", .call = &PrefixCount, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "range", .call = &Range, .isWriteCmd = false, .minArgc = 2, .maxArgc = 2},
+            detail::MainCommandWrapper{.name = "revrange", .call = &RevRange, .isWriteCmd = false, .minArgc = 2, .maxArgc = 2},
+            detail::MainCommandWrapper{.name = "ttl", .call = &TTL, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "pttl", .call = &PTTL, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1},
+
+            detail::MainCommandWrapper{.name = "set", .call = &StrSet, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2},
+            detail::MainCommandWrapper{.name = "mset", .call = &StrMultiSet, .isWriteCmd = true, .minArgc = 2, .maxArgc = detail::MAX_COMMAND_PARAM_NUMBER},
+            detail::MainCommandWrapper{.name = "append", .call = &StrAppend, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2},
+
+            detail::MainCommandWrapper{.name = "del", .call = &Del, .isWriteCmd = true, .minArgc = 1, .maxArgc = detail::MAX_COMMAND_PARAM_NUMBER},
+
+            detail::MainCommandWrapper{.name = "rename", .call = &Rename, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2},
+            detail::MainCommandWrapper{.name = "incr", .call = &Incr, .isWriteCmd = true, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "decr", .call = &Decr, .isWriteCmd = true, .minArgc = 1, .maxArgc = 1},
+            detail::MainCommandWrapper{.name = "incrby", .call = &IncrBy, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2},
+            detail::MainCommandWrapper{.name = "decrby", .call = &DecrBy, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2},
+            detail::MainCommandWrapper{.name = "incrbyfloat", .call = &IncrByFloat, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2},
+    };
+    static_assert(MainCommandTable.size() <= 64, "matchedMainCommand bitmask holds at most 64 commands");
+
+    namespace detail {
+        constexpr std::uint64_t MainCommandMask(std::initializer_list<std::string_view> names) {
+            std::uint64_t mask = 0;
+            for (auto name: names) {
+                std::size_t i = 0;
+                while ((i < MainCommandTable.size()) && (MainCommandTable[i].name != name)) ++i;
+                if (i == MainCommandTable.size()) throw "unknown main command";
+                mask |= (1ULL << i);
+            }
+            return mask;
+        }
+
+        constexpr std::uint16_t CommandOptionMask(std::initializer_list<CmdOptionType> types) {
+            std::uint16_t mask = 0;
+            for (auto type: types)
+                mask |= static_cast<std::uint16_t>(1U << static_cast<std::uint8_t>(type));
+            return mask;
+        }
     }// namespace detail
 
-    const std::unordered_map<std::string, detail::MainCommandWrapper>
-            MainCommandMap{
-                    {"select", detail::MainCommandWrapper{.call = &SwitchDB, .isWriteCmd = true, .minArgc = 1, .maxArgc = 1}},
-                    {"hello", detail::MainCommandWrapper{.call = &Hello, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1}},
-                    {"merge", detail::MainCommandWrapper{.call = &Merge, .isWriteCmd = false, .minArgc = 0, .maxArgc = 0}},
-                    {"move", detail::MainCommandWrapper{.call = &Move, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2}},
-
-                    {"multi", detail::MainCommandWrapper{.call = nullptr, .isWriteCmd = false, .minArgc = 0, .maxArgc = 0}},
-                    {"discard", detail::MainCommandWrapper{.call = nullptr, .isWriteCmd = false, .minArgc = 0, .maxArgc = 0}},
-                    {"exec", detail::MainCommandWrapper{.call = nullptr, .isWriteCmd = false, .minArgc = 0, .maxArgc = 0}},
-                    {"watch", detail::MainCommandWrapper{.call = &Watch, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1}},
-                    {"unwatch", detail::MainCommandWrapper{.call = &UnWatch, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1}},
-
-                    {"publish", detail::MainCommandWrapper{.call = &PublishWithChannel, .isWriteCmd = false, .minArgc = 2, .maxArgc = 2}},
-                    {"subscribe", detail::MainCommandWrapper{.call = &SubscribeWithChannel, .isWriteCmd = false, .minArgc = 1, .maxArgc = detail::MAX_COMMAND_PARAM_NUMBER}},
-                    {"unsubscribe", detail::MainCommandWrapper{.call = &UnSubscribeWithChannel, .isWriteCmd = false, .minArgc = 1, .maxArgc = detail::MAX_COMMAND_PARAM_NUMBER}},
-
-                    {"get", detail::MainCommandWrapper{.call = &StrGet, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1}},
-                    {"exists", detail::MainCommandWrapper{.call = &Exists, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1}},
-                    {"getrange", detail::MainCommandWrapper{.call = &StrGetRange, .isWriteCmd = false, .minArgc = 3, .maxArgc = 3}},
-                    {"mget", detail::MainCommandWrapper{.call = &StrMultiGet, .isWriteCmd = false, .minArgc = 1, .maxArgc = detail::MAX_COMMAND_PARAM_NUMBER}},
-                    {"strlen", detail::MainCommandWrapper{.call = &StrLength, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1}},
-                    {"prefix", detail::MainCommandWrapper{.call = &Prefix, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1}},
-                    {"ttl", detail::MainCommandWrapper{.call = &TTL, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1}},
-                    {"pttl", detail::MainCommandWrapper{.call = &PTTL, .isWriteCmd = false, .minArgc = 1, .maxArgc = 1}},
-
-                    {"set", detail::MainCommandWrapper{.call = &StrSet, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2}},
-                    {"mset", detail::MainCommandWrapper{.call = &StrMultiSet, .isWriteCmd = true, .minArgc = 2, .maxArgc = detail::MAX_COMMAND_PARAM_NUMBER}},
-                    {"append", detail::MainCommandWrapper{.call = &StrAppend, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2}},
-
-                    {"del", detail::MainCommandWrapper{.call = &Del, .isWriteCmd = true, .minArgc = 1, .maxArgc = detail::MAX_COMMAND_PARAM_NUMBER}},
-
-                    {"rename", detail::MainCommandWrapper{.call = &Rename, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2}},
-                    {"incr", detail::MainCommandWrapper{.call = &Incr, .isWriteCmd = true, .minArgc = 1, .maxArgc = 1}},
-                    {"decr", detail::MainCommandWrapper{.call = &Decr, .isWriteCmd = true, .minArgc = 1, .maxArgc = 1}},
-                    {"incrby", detail::MainCommandWrapper{.call = &IncrBy, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2}},
-                    {"decrby", detail::MainCommandWrapper{.call = &DecrBy, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2}},
-                    {"incrbyfloat", detail::MainCommandWrapper{.call = &IncrByFloat, .isWriteCmd = true, .minArgc = 2, .maxArgc = 2}},
-            };
-
-    const std::unordered_map<std::string, detail::CommandOptionWrapper>
-            CommandOptionMap{
-                    {"ex", detail::CommandOptionWrapper{.type = CmdOptionType::kEX, .matchedMainCommand = {"set", "mset"}, .exclusiveOpts = {CmdOptionType::kPX, CmdOptionType::kKEEPTTL}, .minArgc = 1, .maxArgc = 1}},
-                    {"px", detail::CommandOptionWrapper{.type = CmdOptionType::kPX, .matchedMainCommand = {"set", "mset"}, .exclusiveOpts = {CmdOptionType::kEX, CmdOptionType::kKEEPTTL}, .minArgc = 1, .maxArgc = 1}},
-                    {"nx", detail::CommandOptionWrapper{.type = CmdOptionType::kNX, .matchedMainCommand = {"set", "mset"}, .exclusiveOpts = {CmdOptionType::kXX}, .minArgc = 0, .maxArgc = 0}},
-                    {"xx", detail::CommandOptionWrapper{.type = CmdOptionType::kXX, .matchedMainCommand = {"set", "mset"}, .exclusiveOpts = {CmdOptionType::kNX}, .minArgc = 0, .maxArgc = 0}},
-                    {"keepttl", detail::CommandOptionWrapper{.type = CmdOptionType::kKEEPTTL, .matchedMainCommand = {"set", "mset"}, .exclusiveOpts = {CmdOptionType::kEX, CmdOptionType::kPX}, .minArgc = 0, .maxArgc = 0}},
-                    {"get", detail::CommandOptionWrapper{.type = CmdOptionType::kGET, .matchedMainCommand = {"set", "mset"}, .minArgc = 0, .maxArgc = 0}},
-            };
-}// namespace foxbatdb
\ No newline at end of file
+    inline constexpr std::array CommandOptionTable{
+            detail::CommandOptionWrapper{.name = "ex", .type = CmdOptionType::kEX, .matchedMainCommand = detail::MainCommandMask({"set", "mset"}), .exclusiveOpts = detail::CommandOptionMask({CmdOptionType::kPX, CmdOptionType::kKEEPTTL}), .minArgc = 1, .maxArgc = 1},
+            detail::CommandOptionWrapper{.name = "px", .type = CmdOptionType::kPX, .matchedMainCommand = detail::MainCommandMask({"set", "mset"}), .exclusiveOpts = detail::CommandOptionMask({CmdOptionType::kEX, CmdOptionType::kKEEPTTL}), .minArgc = 1, .maxArgc = 1},
+            detail::CommandOptionWrapper{.name = "nx", .type = CmdOptionType::kNX, .matchedMainCommand = detail::MainCommandMask({"set", "mset"}), .exclusiveOpts = detail::CommandOptionMask({CmdOptionType::kXX}), .minArgc = 0, .maxArgc = 0},
+            detail::CommandOptionWrapper{.name = "xx", .type = CmdOptionType::kXX, .matchedMainCommand = detail::MainCommandMask({"set", "mset"}), .exclusiveOpts = detail::CommandOptionMask({CmdOptionType::kNX}), .minArgc = 0, .maxArgc = 0},
+            detail::CommandOptionWrapper{.name = "keepttl", .type = CmdOptionType::kKEEPTTL, .matchedMainCommand = detail::MainCommandMask({"set", "mset"}), .exclusiveOpts = detail::CommandOptionMask({CmdOptionType::kEX, CmdOptionType::kPX}), .minArgc = 0, .maxArgc = 0},
+            detail::CommandOptionWrapper{.name = "get", .type = CmdOptionType::kGET, .matchedMainCommand = detail::MainCommandMask({"set", "mset"}), .minArgc = 0, .maxArgc = 0},
+            detail::CommandOptionWrapper{.name = "match", .type = CmdOptionType::kMATCH, .matchedMainCommand = detail::MainCommandMask({"scan"}), .minArgc = 1, .maxArgc = 1},
+            detail::CommandOptionWrapper{.name = "count", .type = CmdOptionType::kCOUNT, .matchedMainCommand = detail::MainCommandMask({"scan", "pscan"}), .minArgc = 1, .maxArgc = 1},
+            detail::CommandOptionWrapper{.name = "limit", .type = CmdOptionType::kLIMIT, .matchedMainCommand = detail::MainCommandMask({"prefixkeys", "range", "revrange"}), .minArgc = 1, .maxArgc = 1},
+            detail::CommandOptionWrapper{.name = "bcast", .type = CmdOptionType::kBCAST, .matchedMainCommand = detail::MainCommandMask({"client"}), .minArgc = 0, .maxArgc = 0},
+            detail::CommandOptionWrapper{.name = "prefix", .type = CmdOptionType::kPREFIX, .matchedMainCommand = detail::MainCommandMask({"client"}), .minArgc = 1, .maxArgc = 1},
+    };
+
+    namespace detail {
+        inline constexpr auto MainCommandIndex = BuildPerfectHashIndex<128>(MainCommandTable);
+        inline constexpr auto CommandOptionIndex = BuildPerfectHashIndex<32>(CommandOptionTable);
+    }// namespace detail
+
+    // 大小写不敏感，不存在时返回nullptr
+    constexpr const detail::MainCommandWrapper* FindMainCommand(std::string_view name) {
+        return detail::MainCommandIndex.Find(MainCommandTable, name);
+    }
+
+    constexpr const detail::CommandOptionWrapper* FindCommandOption(std::string_view name) {
+        return detail::CommandOptionIndex.Find(CommandOptionTable, name);
+    }
+
+    constexpr std::size_t MainCommandIdx(const detail::MainCommandWrapper* cmd) {
+        return static_cast<std::size_t>(cmd - MainCommandTable.data());
+    }
+
+    static_assert(FindMainCommand("IncrByFloat") == &MainCommandTable[MainCommandTable.size() - 1]);
+    static_assert(!FindMainCommand("incrbyfloa"));
+}// namespace foxbatdb
@@ -3,13 +3,15 @@
 #include "core/db.h"
 #include "errors/runtime.h"
 #include "frontend/server.h"
+#include "log/checkpoint.h"
 #include "parser.h"
 #include "utils/resp.h"
 #include <algorithm>
 
 namespace foxbatdb {
     CMDExecutor::CMDExecutor()
-        : mDB_{DatabaseManager::GetInstance().GetDBByIndex(0)}, mTxState_{TxState::kNoTx} {}
+        : mDB_{DatabaseManager::GetInstance().GetDBByIndex(0)}, mTxState_{TxState::kNoTx},
+          mTrackingMode_{TrackingMode::kOff} {}
 
     Database* CMDExecutor::CurrentDB() { return mDB_; }
 
@@ -17,6 +19,17 @@ namespace foxbatdb {
         mDB_ = DatabaseManager::GetInstance().GetDBByIndex(dbIdx);
     }
 
+    bool CMDExecutor::IsInTxMode() const { return TxState::kNoTx != mTxState_; }
+
+    TrackingMode CMDExecutor::GetTrackingMode() const { return mTrackingMode_.load(std::memory_order_relaxed); }
+
+    const std::vector<std::string>& CMDExecutor::TrackingPrefixes() const { return mTrackingPrefixes_; }
+
+    void CMDExecutor::SetTracking(TrackingMode mode, std::vector<std::string> prefixes) {
+        mTrackingMode_.store(mode, std::memory_order_relaxed);
+        mTrackingPrefixes_ = std::move(prefixes);
+    }
+
     void CMDExecutor::EnableTxMode() {
         mTxState_ = TxState::kAppend;
     }
@@ -25,6 +38,7 @@ namespace foxbatdb {
         mTxState_ = TxState::kNoTx;
         mCmdQueue_.clear();
         mCmdQueue_.shrink_to_fit();
+        mTxArena_.release();
         mTxUndo_.clear();
         mTxUndo_.shrink_to_fit();
         ClearWatchKey();
@@ -76,7 +90,7 @@ namespace foxbatdb {
         mDB_->InsertTxFlag(RecordState::kBegin, mCmdQueue_.size());
         while (!mCmdQueue_.empty()) {
             // ͶӦִ
-            auto cmdInfo = mCmdQueue_.front();
+            auto cmdInfo = std::move(mCmdQueue_.front());
             mCmdQueue_.pop_front();
             if (!cmdInfo.isValidCmd || isTxFailedBefore_) {
                 mDB_->InsertTxFlag(RecordState::kFailed);
@@ -90,7 +104,7 @@ namespace foxbatdb {
                 RollbackTx();
                 return utils::NULL_RESPONSE;
             }
-            resps.emplace_back(resp);
+            resps.emplace_back(std::move(resp));
         }
         mDB_->InsertTxFlag(RecordState::kFinish);
         CancelTxMode();
@@ -98,7 +112,9 @@ namespace foxbatdb {
     }
 
     void CMDExecutor::AppendUndoLog(const Command& cmd) {
-        mTxUndo_.emplace_back(cmd.argv[0], mDB_->GetRecordSnapshot(cmd.argv[0]));
+        std::string key{cmd.argv[0]};
+        auto snapshot = mDB_->GetRecordSnapshot(key);
+        mTxUndo_.emplace_back(std::move(key), std::move(snapshot));
     }
 
     void CMDExecutor::RollbackTx() {
@@ -124,7 +140,7 @@ namespace foxbatdb {
         // ͶӦִ
         ProcResult result = (*(cmd.call))(weak, cmd);
         // ִнӦ
-        return {result.hasError, result.data};
+        return {result.hasError, std::move(result.data)};
     }
 
     void CMDExecutor::AddWatchKey(const std::string& key) {
@@ -150,6 +166,11 @@ namespace foxbatdb {
             return resp;
         }
 
+        // дύڼֹ¼־λ
+        std::shared_lock<std::shared_mutex> checkpointGuard;
+        if (((TxState::kNoTx == mTxState_) && result.isWriteCmd) || (TxState::kExec == mTxState_))
+            checkpointGuard = IndexCheckpoint::GetInstance().LockForWrite();
+
         switch (mTxState_) {
             case TxState::kNoTx:
                 resp = result.ec ? utils::BuildResponse(result.ec) : Exec(weak, result.data);
@@ -165,7 +186,7 @@ namespace foxbatdb {
                     resp = utils::BuildResponse(error::RuntimeErrorCode::kWatchedKeyModified);
                 } else {
                     mCmdQueue_.emplace_back(CommandInfo{
-                            .cmd = result.data,
+                            .cmd = result.data.CopyTo(&mTxArena_),
                             .isValidCmd = (result.ec == error::ProtocolErrorCode::kSuccess),
                             .errmsg = utils::BuildResponse(result.ec),
                     });
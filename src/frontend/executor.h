@@ -1,8 +1,11 @@
 #pragma once
 #include "cmdmap.h"
+#include "core/tracking.h"
+#include <atomic>
 #include <cstdint>
 #include <deque>
 #include <memory>
+#include <memory_resource>
 #include <string>
 #include <vector>
 
@@ -41,8 +44,11 @@ namespace foxbatdb {
         TxState mTxState_;
         bool isTxFailedBefore_ = false;
         std::deque<CommandInfo> mCmdQueue_;
+        std::pmr::monotonic_buffer_resource mTxArena_;// 事务队列中命令参数的副本，事务结束时整体回收
         std::vector<std::string> mWatchedKeyList_;
         std::deque<TxUndoInfo> mTxUndo_;
+        std::atomic<TrackingMode> mTrackingMode_;// 其他线程发送失效消息前读取
+        std::vector<std::string> mTrackingPrefixes_;
 
         void EnableTxMode();
         void CancelTxMode();
@@ -62,9 +68,13 @@ namespace foxbatdb {
         CMDExecutor();
         Database* CurrentDB();
         void SwitchToTargetDB(std::uint8_t dbIdx);
+        [[nodiscard]] bool IsInTxMode() const;
         std::string DoExecOneCmd(std::weak_ptr<CMDSession> weak, const ParseResult& result);
         void AddWatchKey(const std::string& key);
         void DelWatchKey(const std::string& key);
         void SetCurrentTxToFail();
+        [[nodiscard]] TrackingMode GetTrackingMode() const;
+        [[nodiscard]] const std::vector<std::string>& TrackingPrefixes() const;
+        void SetTracking(TrackingMode mode, std::vector<std::string> prefixes);
     };
 }// namespace foxbatdb
\ No newline at end of file
@@ -0,0 +1,45 @@
+#include "outbuf.h"
+#include <algorithm>
+#include <utility>
+
+namespace foxbatdb {
+    OutputBuffer::Segment& OutputBuffer::AppendableChunk(std::size_t size) {
+        if (mSegments_.empty() || !mSegments_.back().appendable ||
+            (mSegments_.back().data.capacity() - mSegments_.back().data.size() < size)) {
+            mSegments_.push_back(Segment{.data = {}, .appendable = true});
+            mSegments_.back().data.reserve(std::max(CHUNK_SIZE, size));
+        }
+        return mSegments_.back();
+    }
+
+    void OutputBuffer::Append(std::string_view data) {
+        if (data.empty()) return;
+        AppendableChunk(data.size()).data.append(data);
+        mSize_ += data.size();
+    }
+
+    void OutputBuffer::Append(std::string&& data) {
+        if (data.size() < ADOPT_THRESHOLD) {
+            Append(std::string_view{data});
+            return;
+        }
+
+        mSize_ += data.size();
+        mSegments_.push_back(Segment{.data = std::move(data), .appendable = false});
+    }
+
+    void OutputBuffer::Clear() {
+        if (!mSegments_.empty() && mSegments_.front().appendable) {
+            mSegments_.resize(1);
+            mSegments_.front().data.clear();
+        } else {
+            mSegments_.clear();
+        }
+        mSize_ = 0;
+    }
+
+    void OutputBuffer::Swap(OutputBuffer& rhs) noexcept {
+        std::swap(mSegments_, rhs.mSegments_);
+        std::swap(mSize_, rhs.mSize_);
+    }
+}// namespace foxbatdb
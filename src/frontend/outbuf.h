@@ -0,0 +1,44 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <string_view>
+
+namespace foxbatdb {
+    // 连接的输出缓冲区：由多个分段组成。较小的响应复制到定长的块中合并，较大的响应整体接管为独立分段、不再复制，
+    // 写出时将各分段作为缓冲区序列交给async_write，由writev一次系统调用聚集写出
+    class OutputBuffer {
+    private:
+        struct Segment {
+            std::string data;
+            bool appendable;// 定长块可继续追加，接管的响应不可追加
+        };
+
+        std::deque<Segment> mSegments_;
+        std::size_t mSize_ = 0;
+
+        Segment& AppendableChunk(std::size_t size);
+
+    public:
+        static constexpr std::size_t CHUNK_SIZE = 16 * 1024;
+        static constexpr std::size_t ADOPT_THRESHOLD = 4 * 1024;// 不小于该长度的右值响应直接接管
+
+        void Append(std::string_view data);
+        void Append(std::string&& data);
+        void Append(const char* data) { Append(std::string_view{data}); }
+
+        [[nodiscard]] std::size_t Size() const { return mSize_; }
+        [[nodiscard]] bool Empty() const { return 0 == mSize_; }
+        // 保留首个定长块的内存供后续复用
+        void Clear();
+        void Swap(OutputBuffer& rhs) noexcept;
+
+        template<typename Visitor>
+        void ForEachSegment(Visitor&& visitor) const {
+            for (const auto& segment: mSegments_) {
+                if (!segment.data.empty())
+                    visitor(std::string_view{segment.data});
+            }
+        }
+    };
+}// namespace foxbatdb
@@ -1,264 +1,161 @@
 ﻿#include "parser.h"
-#include <cctype>
-#include <istream>
-#include <unordered_map>
+#include <charconv>
+#include <cstring>
 
 namespace foxbatdb {
-    namespace detail {
-        static constexpr std::uint16_t MAX_PARAM_COUNT = -1;
+    namespace {
+        constexpr std::size_t NPOS = std::string_view::npos;
+        constexpr std::size_t MAX_PARAM_COUNT = UINT16_MAX;
+        constexpr std::size_t MAX_PARAM_LENGTH = 512 * 1024 * 1024;// 与Redis的proto-max-bulk-len默认值一致
 
-        void ParamCountStartState::react(RequestParser& fsm) {
-            if ('*' == fsm.GetCurrentInput()) {
-                fsm.Transit<ParamCountState>();
-            } else {
-                fsm.Transit<ErrorState>();
-            }
-        }
-
-        void ParamCountState::react(RequestParser& fsm) {
-            char input = fsm.GetCurrentInput();
-            if ('\r' == input) {
-                auto cnt = std::stoul(cntStr);
-                if (cnt > MAX_PARAM_COUNT) {
-                    fsm.Transit<ErrorState>();
-                } else {
-                    fsm.SetParamCnt(cnt);
-                    fsm.Transit<ParamCountEndState>();
-                }
-            } else if ((input < '0') || (input > '9')) {
-                fsm.Transit<ErrorState>();
-            } else {
-                cntStr += input;
-            }
-        }
-
-        void ParamCountState::exit() {
-            cntStr = "";
-        }
-
-        void ParamCountEndState::react(RequestParser& fsm) {
-            if ('\n' != fsm.GetCurrentInput()) {
-                fsm.Transit<ErrorState>();
-            } else {
-                fsm.Transit<ParamLengthStartState>();
-            }
-        }
-
-        void ErrorState::react(RequestParser& fsm) {
-        }
-
-        void ParamLengthStartState::react(RequestParser& fsm) {
-            if ('$' == fsm.GetCurrentInput()) {
-                fsm.Transit<ParamLengthState>();
-            } else {
-                fsm.Transit<ErrorState>();
-            }
-        }
-
-        void ParamLengthState::react(RequestParser& fsm) {
-            char input = fsm.GetCurrentInput();
-            if ('\r' == input) {
-                fsm.SetNextParamLength(std::stoull(lengthStr));
-                fsm.Transit<ParamLengthEndState>();
-            } else if ((input < '0') || (input > '9')) {
-                fsm.Transit<ErrorState>();
-            } else {
-                lengthStr += input;
-            }
-        }
-
-        void ParamLengthState::exit() {
-            lengthStr = "";
-        }
-
-        void ParamLengthEndState::react(RequestParser& fsm) {
-            if ('\n' != fsm.GetCurrentInput()) {
-                fsm.Transit<ErrorState>();
-            } else {
-                fsm.Transit<ParamContentState>();
-            }
-        }
-
-        void ParamContentState::react(RequestParser& fsm) {
-            char input = fsm.GetCurrentInput();
-            if ('\r' != input) {
-                content += input;
-            } else {
-                if (content.size() > fsm.GetNextParamLength())
-                    fsm.Transit<ErrorState>();
-                else {
-                    fsm.AppendParamContent(std::move(content));
-                    fsm.Transit<ParamContentEndState>();
-                }
-            }
-        }
-
-        void ParamContentState::exit() {
-            content = "";
-        }
-
-        void ParamContentEndState::react(RequestParser& fsm) {
-            if ('\n' != fsm.GetCurrentInput()) {
-                fsm.Transit<ErrorState>();
-            } else {
-                if (fsm.GetResult().paramList.size() == fsm.GetResult().paramCnt) {
-                    fsm.SetFinishFlag();
-                    fsm.Transit<ParamCountStartState>();
-                } else
-                    fsm.Transit<ParamLengthStartState>();
-            }
+        const detail::CommandOptionWrapper* TestMainCommandOption(std::uint64_t mainCmdBit, std::string_view str) {
+            // 仅识别当前主命令支持的选项，避免与选项同名的key被误解析
+            const auto* opt = FindCommandOption(str);
+            return (opt && (opt->matchedMainCommand & mainCmdBit)) ? opt : nullptr;
         }
+    }// namespace
 
-        static void Tolower(std::string& str) {
-            for (char& ch: str) {
-                ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
-            }
-        }
+    RequestParser::RequestParser()
+        : mParsedBytes_{0}, mParamCnt_{0}, mNextParamLength_{NPOS},
+          mArenaBuffer_{}, mArena_{mArenaBuffer_.data(), mArenaBuffer_.size()} {}
 
-        bool Result::TestMainCommandAndTolower(std::string& str) {
-            if (str.size() > MAX_COMMAND_NAME_LENGTH)
-                return false;
-
-            auto tmp = str;
-            detail::Tolower(tmp);
-            if (MainCommandMap.contains(tmp)) {
-                str = std::move(tmp);
-                return true;
-            }
-            return false;
-        }
-
-        bool Result::TestMainCommandOptionAndTolower(std::string& str) {
-            if (str.size() > MAX_COMMAND_NAME_LENGTH)
-                return false;
-
-            auto tmp = str;
-            detail::Tolower(tmp);
-            if (CommandOptionMap.contains(tmp)) {
-                str = std::move(tmp);
-                return true;
-            }
-            return false;
-        }
-
-        void Result::ConvertToParseResult(ParseResult& ret) {
-            if (paramList.empty()) {
-                ret.ec = error::ProtocolErrorCode::kRequestFormat;
-                return;
-            }
-
-            if (!Result::TestMainCommandAndTolower(paramList.front())) {
-                ret.ec = error::ProtocolErrorCode::kCommandNotFound;
-                return;
-            }
-
-            const auto& mainCMDName = paramList.front();
-            const auto& mainCMDInfo = MainCommandMap.at(mainCMDName);
-
-            ret.isWriteCmd = mainCMDInfo.isWriteCmd;
-            ret.data.name = mainCMDName;
-            ret.data.call = mainCMDInfo.call;
-
-            BuildCommandData(ret.data);
-            ret.ec = ret.data.Validate();
-        }
-
-        void Result::BuildCommandData(Command& data) {
-            std::size_t i;
-            for (i = 1; i < paramList.size(); ++i) {
-                if (TestMainCommandOptionAndTolower(paramList.at(i)))
-                    break;
-                data.argv.emplace_back(std::move(paramList.at(i)));
-            }
-
-            for (; i < paramList.size(); ++i) {
-                if (TestMainCommandOptionAndTolower(paramList.at(i))) {
-                    const auto& cmdOptInfo = CommandOptionMap.at(paramList.at(i));
-                    CommandOption option{
-                            .name = std::move(paramList.at(i)),
-                            .type = cmdOptInfo.type,
-                            .argv = {}};
-                    data.options.emplace_back(std::move(option));
-                } else {
-                    data.options.back().argv.emplace_back(std::move(paramList.at(i)));
-                }
-            }
-        }
-    }// namespace detail
-
-    RequestParser::RequestParser() : input{}, finished{false}, nextParamLength{0} {
-        mCurrentState_ = &std::get<detail::ParamCountStartState>(mStates_);
-    }
-
-    void RequestParser::SetCurrentInput(char ch) {
-        this->input = ch;
-    }
-
-    void RequestParser::SetParamCnt(std::uint16_t cnt) {
-        this->result.paramCnt = cnt;
-    }
-
-    void RequestParser::AppendParamContent(std::string&& content) {
-        this->result.paramList.emplace_back(std::move(content));
-    }
-
-    const detail::Result& RequestParser::GetResult() const {
-        return this->result;
+    void RequestParser::ResetArena() {
+        mArena_.release();
     }
 
     void RequestParser::Reset() {
-        finished = false;
-        nextParamLength = 0;
-        mCurrentState_ = &std::get<detail::ParamCountStartState>(mStates_);
-        result.paramCnt = 0;
-        result.paramList.clear();
+        mParsedBytes_ = 0;
+        mParamCnt_ = 0;
+        mNextParamLength_ = NPOS;
+        mParams_.clear();
     }
 
-    void RequestParser::RunOnce() {
-        mCurrentState_->react(*this);
+    RequestParser::LineState RequestParser::ParseNumberLine(std::string_view buf, char type, std::size_t& number) {
+        if (mParsedBytes_ >= buf.size())
+            return LineState::kIncomplete;
+        if (type != buf[mParsedBytes_])
+            return LineState::kError;
+
+        // glibc等实现的memchr按字长或SIMD批量比较
+        auto begin = mParsedBytes_ + 1;
+        const auto* cr = static_cast<const char*>(std::memchr(buf.data() + begin, '\r', buf.size() - begin));
+        if (!cr)
+            return LineState::kIncomplete;
+        auto end = static_cast<std::size_t>(cr - buf.data());
+        if (end + 1 >= buf.size())
+            return LineState::kIncomplete;
+        if (('\n' != buf[end + 1]) || (begin == end))
+            return LineState::kError;
+
+        auto [ptr, ec] = std::from_chars(buf.data() + begin, buf.data() + end, number);
+        if ((std::errc{} != ec) || (ptr != buf.data() + end))
+            return LineState::kError;
+
+        mParsedBytes_ = end + 2;
+        return LineState::kOK;
     }
 
-    char RequestParser::GetCurrentInput() const {
-        return this->input;
+    std::error_code RequestParser::ParseFrame(std::string_view buf) {
+        auto toErrorCode = [](LineState state) -> std::error_code {
+            return (LineState::kIncomplete == state) ? error::ProtocolErrorCode::kContinue
+                                                     : error::ProtocolErrorCode::kRequestFormat;
+        };
+
+        if (0 == mParamCnt_) {
+            std::size_t paramCnt = 0;
+            if (auto state = ParseNumberLine(buf, '*', paramCnt); LineState::kOK != state)
+                return toErrorCode(state);
+            if ((0 == paramCnt) || (paramCnt > MAX_PARAM_COUNT))
+                return error::ProtocolErrorCode::kRequestFormat;
+            mParamCnt_ = paramCnt;
+            mParams_.reserve(paramCnt);
+        }
+
+        while (mParams_.size() < mParamCnt_) {
+            if (NPOS == mNextParamLength_) {
+                std::size_t length = 0;
+                if (auto state = ParseNumberLine(buf, '$', length); LineState::kOK != state)
+                    return toErrorCode(state);
+                if (length > MAX_PARAM_LENGTH)
+                    return error::ProtocolErrorCode::kRequestFormat;
+                mNextParamLength_ = length;
+            }
+
+            // 参数内容按声明的长度整段截取，不逐字节扫描
+            if (buf.size() - mParsedBytes_ < mNextParamLength_ + 2)
+                return error::ProtocolErrorCode::kContinue;
+            auto end = mParsedBytes_ + mNextParamLength_;
+            if (('\r' != buf[end]) || ('\n' != buf[end + 1]))
+                return error::ProtocolErrorCode::kRequestFormat;
+
+            mParams_.emplace_back(mParsedBytes_, mNextParamLength_);
+            mParsedBytes_ = end + 2;
+            mNextParamLength_ = NPOS;
+        }
+        return error::ProtocolErrorCode::kSuccess;
     }
 
-    void RequestParser::SetFinishFlag() {
-        finished = true;
+    std::error_code RequestParser::RunFrame(std::string_view buf, std::size_t& consumed,
+                                            std::vector<std::string_view>& params) {
+        consumed = 0;
+        auto ec = ParseFrame(buf);
+        if (error::ProtocolErrorCode::kContinue == ec)
+            return ec;
+
+        if (ec) {
+            // 格式错误时无法确定下一条命令的起始位置，丢弃缓冲区内全部数据
+            consumed = buf.size();
+        } else {
+            consumed = mParsedBytes_;
+            params.clear();
+            for (const auto& [offset, length]: mParams_)
+                params.emplace_back(buf.substr(offset, length));
+        }
+        Reset();
+        return ec;
     }
 
-    bool RequestParser::CheckError() const {
-        return dynamic_cast<detail::ErrorState*>(mCurrentState_) != nullptr;
+    ParseResult RequestParser::Run(std::string_view buf, std::size_t& consumed) {
+        ParseResult ret{.ec = {}, .isWriteCmd = false, .data = Command{&mArena_}};
+        ret.ec = RunFrame(buf, consumed, mParamViews_);
+        if (!ret.ec)
+            ConvertToParseResult(mParamViews_, ret);
+        return ret;
     }
 
-    void RequestParser::SetNextParamLength(std::size_t length) {
-        this->nextParamLength = length;
-    }
+    void RequestParser::ConvertToParseResult(const std::vector<std::string_view>& params, ParseResult& ret) {
+        const auto* mainCMDInfo = FindMainCommand(params.front());
+        if (!mainCMDInfo) {
+            ret.ec = error::ProtocolErrorCode::kCommandNotFound;
+            return;
+        }
 
-    std::size_t RequestParser::GetNextParamLength() const {
-        return this->nextParamLength;
-    }
+        ret.isWriteCmd = mainCMDInfo->isWriteCmd;
+        ret.data.name = mainCMDInfo->name;
+        ret.data.call = mainCMDInfo->call;
 
-    ParseResult RequestParser::Run(std::istream& is, std::size_t bytesTransferred) {
-        char ch;
-        for (std::size_t i = 0; i < bytesTransferred; ++i) {
-            if (!is)
+        std::size_t i;
+        const detail::CommandOptionWrapper* opt = nullptr;
+        const std::uint64_t mainCmdBit = 1ULL << MainCommandIdx(mainCMDInfo);
+        ret.data.argv.reserve(params.size() - 1);
+        for (i = 1; i < params.size(); ++i) {
+            if ((opt = TestMainCommandOption(mainCmdBit, params[i])))
                 break;
-
-            is.get(ch);
-            this->SetCurrentInput(ch);
-            this->RunOnce();
-
-            if (this->CheckError()) {
-                this->Reset();
-                return {.ec = error::ProtocolErrorCode::kRequestFormat};
-            }
+            ret.data.argv.emplace_back(params[i]);
         }
 
-        ParseResult ret{.ec = error::ProtocolErrorCode::kContinue};
-        if (finished) {
-            result.ConvertToParseResult(ret);
-            this->Reset();
+        auto* resource = ret.data.argv.get_allocator().resource();
+        for (; i < params.size(); ++i) {
+            if (opt || (opt = TestMainCommandOption(mainCmdBit, params[i]))) {
+                ret.data.options.emplace_back(CommandOption{
+                        .name = opt->name,
+                        .type = opt->type,
+                        .argv = std::pmr::vector<std::string_view>{resource}});
+                opt = nullptr;
+            } else {
+                ret.data.options.back().argv.emplace_back(params[i]);
+            }
         }
-        return ret;
+        ret.ec = ret.data.Validate();
     }
-}// namespace foxbatdb
\ No newline at end of file
+}// namespace foxbatdb
@@ -1,120 +1,56 @@
 ﻿#pragma once
 #include "cmdmap.h"
 #include "errors/protocol.h"
+#include <array>
 #include <cstddef>
+#include <memory_resource>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace foxbatdb {
-    class RequestParser;
-
     struct ParseResult {
         std::error_code ec;
         bool isWriteCmd;
         Command data;
     };
 
-    namespace detail {
-        struct RESPRequestParseState {
-            virtual void react(RequestParser& fsm) = 0;
-            virtual void exit() {}
-        };
-
-        struct ErrorState : public RESPRequestParseState {
-            void react(RequestParser& fsm) override;
-        };
-
-        struct ParamCountStartState : public RESPRequestParseState {
-            void react(RequestParser& fsm) override;
-        };
-
-        struct ParamCountState : public RESPRequestParseState {
-            void react(RequestParser& fsm) override;
-            void exit() override;
-
-        private:
-            std::string cntStr;
-        };
-
-        struct ParamCountEndState : public RESPRequestParseState {
-            void react(RequestParser& fsm) override;
-        };
-
-        struct ParamLengthStartState : public RESPRequestParseState {
-            void react(RequestParser& fsm) override;
-        };
-
-        struct ParamLengthState : public RESPRequestParseState {
-            void react(RequestParser& fsm) override;
-            void exit() override;
-
-        private:
-            std::string lengthStr;
-        };
-
-        struct ParamLengthEndState : public RESPRequestParseState {
-            void react(RequestParser& fsm) override;
-        };
-
-        struct ParamContentState : public RESPRequestParseState {
-            void react(RequestParser& fsm) override;
-            void exit() override;
-
-        private:
-            std::string content;
-        };
-
-        struct ParamContentEndState : public RESPRequestParseState {
-            void react(RequestParser& fsm) override;
-        };
-
-        struct Result {
-            std::uint16_t paramCnt = 0;
-            std::vector<std::string> paramList;
-
-            static bool TestMainCommandAndTolower(std::string& str);
-            static bool TestMainCommandOptionAndTolower(std::string& str);
-
-            void ConvertToParseResult(ParseResult& ret);
-            void BuildCommandData(Command& data);
-        };
-    }// namespace detail
-
+    // RESP请求解析器：直接在连接的连续读缓冲区上解析，按\r\n定位行尾（memchr），按声明的$len整段截取参数，
+    // 参数以string_view指向读缓冲区；命令不完整时返回kContinue并保留解析进度，缓冲区追加数据后从断点继续。
+    // 命令的参数列表分配自解析器内的单调内存池，每条命令响应后调用ResetArena整体回收
     class RequestParser {
     private:
-        char input;
-        bool finished;
-        detail::Result result;
-        std::size_t nextParamLength;
-        std::tuple<detail::ParamCountStartState, detail::ParamCountState, detail::ParamCountEndState,
-                   detail::ParamLengthStartState, detail::ParamLengthState, detail::ParamLengthEndState,
-                   detail::ParamContentState, detail::ParamContentEndState, detail::ErrorState>
-                mStates_;
-        detail::RESPRequestParseState* mCurrentState_;
+        static constexpr std::size_t ARENA_INITIAL_SIZE = 4096;
+        enum class LineState : std::int8_t {
+            kOK = 0,
+            kIncomplete,
+            kError
+        };
+
+        std::size_t mParsedBytes_;                              // 当前命令已解析的字节数
+        std::size_t mParamCnt_;                                 // 0表示尚未解析参数个数
+        std::size_t mNextParamLength_;                          // 下一个参数的长度，npos表示尚未解析
+        std::vector<std::pair<std::size_t, std::size_t>> mParams_;// 各参数在缓冲区中的偏移量与长度
+        std::vector<std::string_view> mParamViews_;
+        std::array<std::byte, ARENA_INITIAL_SIZE> mArenaBuffer_;
+        std::pmr::monotonic_buffer_resource mArena_;
+
+        LineState ParseNumberLine(std::string_view buf, char type, std::size_t& number);
+        std::error_code ParseFrame(std::string_view buf);
+        void Reset();
 
-        void RunOnce();
-        void SetCurrentInput(char ch);
-        [[nodiscard]] bool CheckError() const;
+        static void ConvertToParseResult(const std::vector<std::string_view>& params, ParseResult& ret);
 
     public:
         RequestParser();
 
-        [[nodiscard]] char GetCurrentInput() const;
-        void SetFinishFlag();
-        void SetParamCnt(std::uint16_t cnt);
-        void SetNextParamLength(std::size_t length);
-        [[nodiscard]] std::size_t GetNextParamLength() const;
-        void AppendParamContent(std::string&& content);
-        [[nodiscard]] const detail::Result& GetResult() const;
-        void Reset();
-
-        ParseResult Run(std::istream& is, std::size_t bytesTransferred);
-
-        template<class S>
-        void Transit() {
-            this->mCurrentState_->exit();
-            this->mCurrentState_ = &std::get<S>(mStates_);
-        }
+        // 解析buf头部的一条命令，consumed为解析完成（或出错需丢弃）的字节数；
+        // 返回kContinue时不消耗任何字节，下次须传入以同一位置开头的缓冲区
+        ParseResult Run(std::string_view buf, std::size_t& consumed);
+        // 仅切分参数，不构建命令；返回的string_view在缓冲区被消耗前有效
+        std::error_code RunFrame(std::string_view buf, std::size_t& consumed, std::vector<std::string_view>& params);
+        // 回收此前Run返回的所有命令占用的内存，调用前须确保这些命令已不再使用
+        void ResetArena();
     };
-}// namespace foxbatdb
\ No newline at end of file
+}// namespace foxbatdb
@@ -2,71 +2,236 @@
 #include "core/db.h"
 #include "errors/runtime.h"
 #include "flag/flags.h"
+#include "frontend/storage.h"
 #include "log/oplog.h"
 #include "log/serverlog.h"
 #include "utils/resp.h"
+#include "utils/utils.h"
+#include <filesystem>
 #include <memory>
+#include <type_traits>
 
 namespace foxbatdb {
-    CMDSession::CMDSession(asio::ip::tcp::socket socket)
-        : mSocket_(std::move(socket)) {
+    using utils::operator""_MB;
+    static constexpr std::size_t MAX_PENDING_OUTPUT_SIZE = 1_MB;
+
+    CMDSession::CMDSession(asio::generic::stream_protocol::socket socket)
+        : mSocket_(std::move(socket)), mStrand_{asio::make_strand(mSocket_.get_executor())},
+          mWriteSignal_{mStrand_, asio::steady_timer::time_point::max()},
+          mDrainSignal_{mStrand_, asio::steady_timer::time_point::max()} {
         mReadBuffer_.prepare(1024);
     }
 
-    void CMDSession::Start() { DoRead(); }
+    // 读、写各一个协程，协程帧持有会话的引用，二者都结束后会话释放
+    void CMDSession::Start() {
+        auto self(shared_from_this());
+        asio::co_spawn(mStrand_, [self] { return self->ReadLoop(); }, asio::detached);
+        asio::co_spawn(mStrand_, [self] { return self->WriteLoop(); }, asio::detached);
+    }
     Database* CMDSession::CurrentDB() { return mExecutor_.CurrentDB(); }
     void CMDSession::SwitchToTargetDB(std::uint8_t dbIdx) { mExecutor_.SwitchToTargetDB(dbIdx); }
     void CMDSession::AddWatchKey(const std::string& key) { mExecutor_.AddWatchKey(key); }
     void CMDSession::DelWatchKey(const std::string& key) { mExecutor_.DelWatchKey(key); }
     void CMDSession::SetCurrentTxToFail() { mExecutor_.SetCurrentTxToFail(); }
+    TrackingMode CMDSession::GetTrackingMode() const { return mExecutor_.GetTrackingMode(); }
+    const std::vector<std::string>& CMDSession::TrackingPrefixes() const { return mExecutor_.TrackingPrefixes(); }
+    void CMDSession::SetTracking(TrackingMode mode, std::vector<std::string> prefixes) {
+        mExecutor_.SetTracking(mode, std::move(prefixes));
+    }
 
     void CMDSession::WritePublishMsg(const std::string& channel,
                                      const std::string& msg) {
-        auto self(shared_from_this());
-        DoWrite(utils::BuildPubSubResponse("message", channel, msg));
+        PostToOutbox(utils::BuildPubSubResponse("message", channel, msg));
     }
 
-    void CMDSession::DoRead() {
-        auto self(shared_from_this());
-        asio::async_read(
-                mSocket_, mReadBuffer_, asio::transfer_at_least(1),
-                [this, self](std::error_code ec, std::size_t bytesTransferred) {
-                    if (!ec) {
-                        ProcessMsg(bytesTransferred);
-                    } else {
-                        ServerLog::GetInstance().Warning("read request from client failed: {}", ec.message());
-                    }
-                });
+    // RESP3推送消息：>2 invalidate [key]
+    void CMDSession::WriteInvalidateMsg(const std::string& key) {
+        std::string keys;
+        utils::AppendArrayHeader(keys, 1);
+        utils::AppendResponse(keys, key);
+
+        std::string resp;
+        detail::BuildPushesResp(resp, {utils::BuildResponse(std::string{"invalidate"}), std::move(keys)});
+        PostToOutbox(std::move(resp));
     }
 
-    void CMDSession::DoWrite(const std::string& data) {
-        auto self(shared_from_this());
-        asio::async_write(mSocket_, asio::buffer(data.data(), data.length()),
-                          [this, self](std::error_code ec, std::size_t) {
-                              if (!ec) {
-                                  DoRead();
-                              } else {
-                                  ServerLog::GetInstance().Warning("write response to client failed: {}", ec.message());
-                              }
-                          });
-    }
-
-    void CMDSession::ProcessMsg(std::size_t bytesTransferred) {
-        std::istream is(&mReadBuffer_);
-        auto result = mParser_.Run(is, bytesTransferred);
-        if (error::ProtocolErrorCode::kContinue == result.ec) {
-            DoRead();
+    // 可在任意线程调用：消息先进入投递队列，再由会话自身的strand写出，不与会话上的读写并发
+    void CMDSession::PostToOutbox(std::string resp) {
+        auto limit = Flags::GetInstance().clientOutputBufferLimit;
+        {
+            std::unique_lock l{mOutboxMt_};
+            if (limit && (mOutboxBytes_ + resp.size() > limit)) {
+                mIsOutboxOverflowed_ = true;// 连接即将断开，不再缓存后续消息
+            } else if (!mIsOutboxOverflowed_) {
+                mOutboxBytes_ += resp.size();
+                mOutbox_.emplace_back(std::move(resp));
+            }
+
+            if (mIsOutboxScheduled_) return;
+            mIsOutboxScheduled_ = true;
+        }
+        asio::post(mStrand_, [self = shared_from_this()] { self->DrainOutbox(); });
+    }
+
+    void CMDSession::DrainOutbox() {
+        std::vector<std::string> outbox;
+        bool isOverflowed;
+        {
+            std::unique_lock l{mOutboxMt_};
+            outbox.swap(mOutbox_);
+            mOutboxBytes_ = 0;
+            mIsOutboxScheduled_ = false;
+            isOverflowed = mIsOutboxOverflowed_;
+        }
+        if (mIsClosed_) return;
+
+        // 本次取出的所有消息合并到输出缓冲区，随下一次写操作一起写出
+        for (auto& msg: outbox)
+            mPendingOutput_.Append(std::move(msg));
+
+        auto limit = Flags::GetInstance().clientOutputBufferLimit;
+        if (isOverflowed || (limit && (mPendingOutput_.Size() + mWritingOutput_.Size() > limit))) {
+            ServerLog::GetInstance().Warning("client output buffer exceeds {} bytes, close slow consumer", limit);
+            Close();
             return;
         }
+        NotifyWriter();
+    }
+
+    void CMDSession::NotifyWriter() {
+        if (mIsWriterWaiting_)
+            mWriteSignal_.cancel();
+    }
+
+    void CMDSession::Close() {
+        if (mIsClosed_) return;
+        mIsClosed_ = true;
+
+        asio::error_code ec;
+        mSocket_.shutdown(asio::socket_base::shutdown_both, ec);
+        mSocket_.close(ec);// 未完成的异步读写以operation_aborted结束，读写协程随之退出
+        mWriteSignal_.cancel();
+        mDrainSignal_.cancel();
+    }
+
+    asio::awaitable<void> CMDSession::ReadLoop() {
+        while (!mIsClosed_) {
+            asio::error_code ec;
+            co_await asio::async_read(mSocket_, mReadBuffer_, asio::transfer_at_least(1),
+                                      asio::redirect_error(asio::use_awaitable, ec));
+            if (ec == asio::error::eof) {
+                // 对端只关闭了写方向：不再读取，已生成的响应由写协程全部写出后再关闭连接
+                mIsReadEOF_ = true;
+                NotifyWriter();
+                co_return;
+            }
+            if (ec) {
+                if (!mIsClosed_)
+                    ServerLog::GetInstance().Warning("read request from client failed: {}", ec.message());
+                break;
+            }
+            co_await ProcessMsg();
+        }
+        Close();
+    }
+
+    asio::awaitable<void> CMDSession::WriteLoop() {
+        while (!mIsClosed_) {
+            if (mPendingOutput_.Empty()) {
+                if (mIsReadEOF_) break;
 
-        if (result.ec) {
-            DoWrite(utils::BuildResponse(result.ec));
-        } else {
-            DoWrite(mExecutor_.DoExecOneCmd(weak_from_this(), result));
-            if (result.isWriteCmd) {
-                OperationLog::GetInstance().AppendCommand(std::move(result.data));
+                asio::error_code ec;
+                mIsWriterWaiting_ = true;
+                co_await mWriteSignal_.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+                mIsWriterWaiting_ = false;
+                continue;
+            }
+
+            // 等待及写操作进行期间生成的响应累积在mPendingOutput_中，合并为一次写操作
+            mWritingOutput_.Clear();
+            mWritingOutput_.Swap(mPendingOutput_);
+            mWriteBuffers_.clear();
+            mWritingOutput_.ForEachSegment([this](std::string_view segment) {
+                mWriteBuffers_.emplace_back(segment.data(), segment.size());
+            });
+            if (mIsReaderWaiting_)
+                mDrainSignal_.cancel();
+
+            asio::error_code ec;
+            co_await asio::async_write(mSocket_, mWriteBuffers_, asio::redirect_error(asio::use_awaitable, ec));
+            if (ec) {
+                if (!mIsClosed_)
+                    ServerLog::GetInstance().Warning("write response to client failed: {}", ec.message());
+                break;
             }
         }
+        Close();
+    }
+
+    asio::awaitable<void> CMDSession::ProcessMsg() {
+        // 依次执行读缓冲区内所有完整的命令（pipeline），响应按序追加，由写协程合并写出；写操作进行期间继续读取后续请求
+        while ((mReadBuffer_.size() > 0) && !mIsClosed_) {
+            if (mPendingOutput_.Size() >= MAX_PENDING_OUTPUT_SIZE) {
+                // 待写出的响应过多时暂停处理剩余命令，待写协程取走后再继续
+                asio::error_code ec;
+                mIsReaderWaiting_ = true;
+                co_await mDrainSignal_.async_wait(asio::redirect_error(asio::use_awaitable, ec));
+                mIsReaderWaiting_ = false;
+                continue;
+            }
+
+            // 直接在读缓冲区上解析，命令参数为缓冲区的视图，命令执行完毕后才消费对应字节
+            std::size_t consumed = 0;
+            std::string_view view{static_cast<const char*>(mReadBuffer_.data().data()), mReadBuffer_.size()};
+            {
+                auto result = mParser_.Run(view, consumed);
+                if (error::ProtocolErrorCode::kContinue == result.ec)
+                    break;
+
+                if (result.ec) {
+                    mPendingOutput_.Append(utils::BuildResponse(result.ec));
+                } else {
+                    mPendingOutput_.Append(co_await ExecCmd(result));
+                }
+                NotifyWriter();
+            }
+            mReadBuffer_.consume(consumed);
+            mParser_.ResetArena();
+        }
+    }
+
+    asio::awaitable<std::string> CMDSession::ExecCmd(const ParseResult& result) {
+        // 事务中的命令仅入队，不访问数据文件
+        if (StorageExecutor::GetInstance().IsEnabled() && !mExecutor_.IsInTxMode() &&
+            StorageExecutor::IsStorageCmd(result.data))
+            co_return co_await ExecOnStorage(result);
+
+        auto resp = mExecutor_.DoExecOneCmd(weak_from_this(), result);
+        if (result.isWriteCmd) {
+            OperationLog::GetInstance().AppendCommand(result.data);
+        }
+        co_return resp;
+    }
+
+    asio::awaitable<std::string> CMDSession::ExecOnStorage(const ParseResult& result) {
+        co_return co_await asio::async_initiate<decltype(asio::use_awaitable), void(std::string)>(
+                [this, &result](auto handler) {
+                    auto done = std::make_shared<decltype(handler)>(std::move(handler));
+                    StorageExecutor::Task task = [self = shared_from_this(), &result, done] {
+                        auto resp = self->mExecutor_.DoExecOneCmd(self, result);
+                        if (result.isWriteCmd)
+                            OperationLog::GetInstance().AppendCommand(result.data);
+                        // 响应经连接的strand交回其所在的IO线程
+                        auto ex = asio::get_associated_executor(*done);
+                        asio::post(ex, [done, resp = std::move(resp)]() mutable {
+                            (*done)(std::move(resp));
+                        });
+                    };
+                    // 队列已满时在IO线程上直接执行，以此限制积压的磁盘请求
+                    if (!StorageExecutor::GetInstance().TryPost(task))
+                        task();
+                },
+                asio::use_awaitable);
     }
 
     detail::IOContextPool::IOContextPool() : nextIOContext_{0} {
@@ -84,8 +249,16 @@ namespace foxbatdb {
     void detail::IOContextPool::Run() {
         std::vector<std::thread> threads;
         threads.reserve(ioContexts_.size());
-        for (auto& io_context: ioContexts_)
-            threads.emplace_back([&io_context] { io_context->run(); });
+        for (std::size_t i = 0; i < ioContexts_.size(); ++i) {
+            threads.emplace_back([this, i] {
+                // 先绑定CPU再运行：Linux默认按首次访问在本地NUMA节点分配内存，
+                // 连接在接受它的线程上创建，其读写缓冲区等均分配在该线程所在节点
+                const auto& cpus = Flags::GetInstance().ioThreadCpuAffinity;
+                if (!cpus.empty() && !utils::SetCurrentThreadAffinity({cpus[i % cpus.size()]}))
+                    ServerLog::GetInstance().Warning("bind io thread {} to cpu {} failed", i, cpus[i % cpus.size()]);
+                ioContexts_[i]->run();
+            });
+        }
 
         for (auto& thread: threads) {
             if (thread.joinable())
@@ -98,21 +271,88 @@ namespace foxbatdb {
             ioCtx->stop();
     }
 
+    std::size_t detail::IOContextPool::Size() const { return ioContexts_.size(); }
+
     asio::io_context& detail::IOContextPool::GetIOContext() {
-        asio::io_context& ioCtx = *ioContexts_[nextIOContext_];
-        ++nextIOContext_;
-        if (nextIOContext_ == ioContexts_.size())
-            nextIOContext_ = 0;
-        return ioCtx;
+        auto idx = nextIOContext_.fetch_add(1, std::memory_order_relaxed);
+        return *ioContexts_[idx % ioContexts_.size()];
     }
 
+    asio::io_context& detail::IOContextPool::GetIOContext(std::size_t idx) {
+        return *ioContexts_[idx];
+    }
+
+    namespace {
+#if defined(SO_REUSEPORT)
+        using ReusePortOption = asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+#endif
+
+        asio::ip::tcp::acceptor MakeAcceptor(asio::io_context& ioCtx, bool isReusePort) {
+            asio::ip::tcp::endpoint endpoint{asio::ip::tcp::v4(), Flags::GetInstance().port};
+            asio::ip::tcp::acceptor acceptor{ioCtx};
+            acceptor.open(endpoint.protocol());
+            acceptor.set_option(asio::ip::tcp::acceptor::reuse_address(true));
+#if defined(SO_REUSEPORT)
+            if (isReusePort)
+                acceptor.set_option(ReusePortOption(true));
+#endif
+            acceptor.bind(endpoint);
+            acceptor.listen();
+            return acceptor;
+        }
+
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+        asio::local::stream_protocol::acceptor MakeUnixAcceptor(asio::io_context& ioCtx, const std::string& path) {
+            // 删除上次运行遗留的socket文件，否则bind失败
+            std::error_code ec;
+            std::filesystem::remove(path, ec);
+
+            asio::local::stream_protocol::endpoint endpoint{path};
+            asio::local::stream_protocol::acceptor acceptor{ioCtx};
+            acceptor.open(endpoint.protocol());
+            acceptor.bind(endpoint);
+            acceptor.listen();
+            return acceptor;
+        }
+#endif
+    }// namespace
+
     DBServer::DBServer()
         : ioContextPool_{},
-          signals_(ioContextPool_.GetIOContext()),
-          acceptor_{ioContextPool_.GetIOContext(), asio::ip::tcp::endpoint(asio::ip::tcp::v4(),
-                                                                           Flags::GetInstance().port)} {
+          signals_(ioContextPool_.GetIOContext(0)) {
+#if defined(SO_REUSEPORT)
+        isReusePort_ = Flags::GetInstance().reusePort && (ioContextPool_.Size() > 1);
+#else
+        isReusePort_ = false;
+#endif
+        // 端口为0时不监听TCP，仅通过Unix域socket提供服务
+        const auto& flags = Flags::GetInstance();
+        auto acceptorNum = (0 == flags.port) ? 0 : (isReusePort_ ? ioContextPool_.Size() : 1);
+        acceptors_.reserve(acceptorNum);
+        for (std::size_t i = 0; i < acceptorNum; ++i)
+            acceptors_.emplace_back(MakeAcceptor(ioContextPool_.GetIOContext(i), isReusePort_));
+
+        if (!flags.unixSocketPath.empty()) {
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+            unixAcceptor_.emplace(MakeUnixAcceptor(ioContextPool_.GetIOContext(0), flags.unixSocketPath));
+#else
+            ServerLog::GetInstance().Warning("unix domain socket is not supported on this platform");
+#endif
+        }
+        bool hasUnixAcceptor = false;
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+        hasUnixAcceptor = unixAcceptor_.has_value();
+#endif
+        if (acceptors_.empty() && !hasUnixAcceptor)
+            throw std::runtime_error("neither tcp port nor unix socket path is configured");
+
         this->DoWaitSignals();
-        this->DoAccept();
+        for (auto& acceptor: acceptors_)
+            this->DoAccept(acceptor, isReusePort_);
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+        if (unixAcceptor_)
+            this->DoAccept(*unixAcceptor_, false);
+#endif
     }
 
     DBServer& DBServer::GetInstance() {
@@ -120,20 +360,36 @@ namespace foxbatdb {
         return instance;
     }
 
-    void DBServer::Run() { ioContextPool_.Run(); }
+    void DBServer::Run() {
+        ioContextPool_.Run();
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+        if (unixAcceptor_) {
+            std::error_code ec;
+            std::filesystem::remove(Flags::GetInstance().unixSocketPath, ec);
+        }
+#endif
+    }
 
-    void DBServer::DoAccept() {
-        this->acceptor_.async_accept(
-                ioContextPool_.GetIOContext(),
-                [this](std::error_code ec, asio::ip::tcp::socket socket) {
-                    if (!acceptor_.is_open()) return;
+    template<typename Acceptor>
+    void DBServer::DoAccept(Acceptor& acceptor, bool isOwnThread) {
+        auto& ioCtx = isOwnThread ? static_cast<asio::io_context&>(acceptor.get_executor().context())
+                                  : ioContextPool_.GetIOContext();
+        acceptor.async_accept(
+                ioCtx,
+                [this, &acceptor, isOwnThread](std::error_code ec, typename Acceptor::protocol_type::socket socket) {
+                    if (!acceptor.is_open()) return;
 
                     if (!ec) {
+                        // 关闭Nagle算法：写出一批响应时若上一批尚未被确认，后一批会等待客户端的延迟ACK（约40ms）
+                        if constexpr (std::is_same_v<typename Acceptor::protocol_type, asio::ip::tcp>) {
+                            asio::error_code optEc;
+                            socket.set_option(asio::ip::tcp::no_delay(true), optEc);
+                        }
                         std::make_shared<CMDSession>(std::move(socket))->Start();
                     } else {
                         ServerLog::GetInstance().Warning("accept connection failed: {}", ec.message());
                     }
-                    this->DoAccept();
+                    this->DoAccept(acceptor, isOwnThread);
                 });
     }
 
@@ -1,16 +1,23 @@
 #pragma once
 #include "asio.hpp"
 #include "frontend/executor.h"
+#include "frontend/outbuf.h"
 #include "frontend/parser.h"
+#include <atomic>
 #include <list>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace foxbatdb {
     class Database;
 
     class CMDSession : public std::enable_shared_from_this<CMDSession> {
     public:
-        explicit CMDSession(asio::ip::tcp::socket socket);
+        // TCP与Unix域socket的连接均转换为通用流socket，共用同一套会话逻辑
+        explicit CMDSession(asio::generic::stream_protocol::socket socket);
         CMDSession(const CMDSession&) = delete;
         CMDSession(CMDSession&&) = delete;
         ~CMDSession() = default;
@@ -27,17 +34,46 @@ namespace foxbatdb {
         void DelWatchKey(const std::string& key);
         void SetCurrentTxToFail();
 
+        [[nodiscard]] TrackingMode GetTrackingMode() const;
+        [[nodiscard]] const std::vector<std::string>& TrackingPrefixes() const;
+        void SetTracking(TrackingMode mode, std::vector<std::string> prefixes);
+
         void WritePublishMsg(const std::string& channel, const std::string& msg);
+        void WriteInvalidateMsg(const std::string& key);
 
     private:
-        asio::ip::tcp::socket mSocket_;
+        asio::generic::stream_protocol::socket mSocket_;
+        asio::strand<asio::any_io_executor> mStrand_;// 会话的读写协程、命令执行与消息投递均在该strand上串行执行
+        asio::steady_timer mWriteSignal_;            // 永不到期，写协程在其上等待新的响应，取消即唤醒
+        asio::steady_timer mDrainSignal_;            // 永不到期，读协程在其上等待待写出的响应减少
         asio::streambuf mReadBuffer_;
         RequestParser mParser_;
         CMDExecutor mExecutor_;
-
-        void DoRead();
-        void DoWrite(const std::string& data);
-        void ProcessMsg(std::size_t bytesTransferred);
+        OutputBuffer mPendingOutput_;                  // 已生成、尚未写出的响应
+        OutputBuffer mWritingOutput_;                  // 正在写出的响应，写操作完成前须保持有效
+        std::vector<asio::const_buffer> mWriteBuffers_;// mWritingOutput_各分段，用于聚集写
+        bool mIsWriterWaiting_ = false;
+        bool mIsReaderWaiting_ = false;
+        bool mIsReadEOF_ = false;// 对端已关闭写方向，写完剩余响应后关闭连接
+        bool mIsClosed_ = false;
+
+        // 其他线程投递的订阅消息（多生产者），由strand上的DrainOutbox按投递顺序取出并写出
+        std::mutex mOutboxMt_;
+        std::vector<std::string> mOutbox_;
+        std::size_t mOutboxBytes_ = 0;
+        bool mIsOutboxScheduled_ = false;
+        bool mIsOutboxOverflowed_ = false;
+
+        asio::awaitable<void> ReadLoop();
+        asio::awaitable<void> WriteLoop();
+        asio::awaitable<void> ProcessMsg();
+        // 执行命令并返回响应；命令可能在存储线程上执行，返回前命令参数须保持有效
+        asio::awaitable<std::string> ExecCmd(const ParseResult& result);
+        asio::awaitable<std::string> ExecOnStorage(const ParseResult& result);
+        void PostToOutbox(std::string msg);
+        void NotifyWriter();
+        void DrainOutbox();
+        void Close();
     };
 
     namespace detail {
@@ -49,12 +85,14 @@ namespace foxbatdb {
 
             void Run();
             void Stop();
-            asio::io_context& GetIOContext();
+            [[nodiscard]] std::size_t Size() const;
+            asio::io_context& GetIOContext();// 轮询选取，可在任意线程调用
+            asio::io_context& GetIOContext(std::size_t idx);
 
         private:
             std::vector<std::shared_ptr<asio::io_context>> ioContexts_;
             std::list<asio::executor_work_guard<asio::io_context::executor_type>> work_;
-            std::size_t nextIOContext_;
+            std::atomic<std::size_t> nextIOContext_;
         };
     }// namespace detail
 
@@ -72,10 +110,18 @@ namespace foxbatdb {
     private:
         detail::IOContextPool ioContextPool_;
         asio::signal_set signals_;
-        asio::ip::tcp::acceptor acceptor_;
+        // 开启SO_REUSEPORT时每个IO线程各有一个监听socket，由内核分发新连接，连接留在接受它的线程上；
+        // 否则只有一个监听socket，新连接轮询分配给各IO线程
+        std::vector<asio::ip::tcp::acceptor> acceptors_;
+        bool isReusePort_;
+#if defined(ASIO_HAS_LOCAL_SOCKETS)
+        std::optional<asio::local::stream_protocol::acceptor> unixAcceptor_;// 新连接轮询分配给各IO线程
+#endif
 
         DBServer();
-        void DoAccept();
+        // isOwnThread为true时新连接由监听socket所在的IO线程处理，否则轮询分配
+        template<typename Acceptor>
+        void DoAccept(Acceptor& acceptor, bool isOwnThread);
         void DoWaitSignals();
     };
 }// namespace foxbatdb
\ No newline at end of file
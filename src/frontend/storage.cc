@@ -0,0 +1,72 @@
+#include "storage.h"
+#include "cmdmap.h"
+#include "flag/flags.h"
+#include "log/serverlog.h"
+#include "utils/utils.h"
+
+namespace foxbatdb {
+    namespace {
+        // 需按偏移量读取数据文件中value的命令
+        constexpr std::uint64_t STORAGE_COMMANDS = detail::MainCommandMask({
+                "get", "mget", "getrange", "strlen", "prefix", "range", "revrange", "pscan",
+                "append", "incr", "decr", "incrby", "decrby", "incrbyfloat", "rename", "move", "merge"});
+    }// namespace
+
+    StorageExecutor::~StorageExecutor() {
+        {
+            std::unique_lock l{mt_};
+            mIsStopped_ = true;
+        }
+        mCond_.notify_all();
+        for (auto& worker: mWorkers_)
+            worker.join();
+    }
+
+    StorageExecutor& StorageExecutor::GetInstance() {
+        static StorageExecutor instance;
+        return instance;
+    }
+
+    void StorageExecutor::Init() {
+        const auto& flags = Flags::GetInstance();
+        mCapacity_ = flags.storageQueueSize;
+        for (std::size_t i = 0; i < flags.storageThreadNum; ++i)
+            mWorkers_.emplace_back([this] { WorkerLoop(); });
+    }
+
+    bool StorageExecutor::IsEnabled() const { return !mWorkers_.empty(); }
+
+    bool StorageExecutor::IsStorageCmd(const Command& cmd) {
+        const auto* info = FindMainCommand(cmd.name);
+        return info && ((1ULL << MainCommandIdx(info)) & STORAGE_COMMANDS);
+    }
+
+    bool StorageExecutor::TryPost(Task& task) {
+        if (!IsEnabled()) return false;
+        {
+            std::unique_lock l{mt_};
+            if (mIsStopped_ || (mTasks_.size() >= mCapacity_)) return false;
+            mTasks_.emplace_back(std::move(task));
+        }
+        mCond_.notify_one();
+        return true;
+    }
+
+    void StorageExecutor::WorkerLoop() {
+        // 与定时任务线程共用后台线程的CPU，不占用IO线程所在的CPU
+        if (!utils::SetCurrentThreadAffinity(Flags::GetInstance().backgroundThreadCpuAffinity))
+            ServerLog::GetInstance().Warning("bind storage thread to cpus failed");
+
+        for (;;) {
+            Task task;
+            {
+                std::unique_lock l{mt_};
+                mCond_.wait(l, [this] { return mIsStopped_ || !mTasks_.empty(); });
+                if (mTasks_.empty()) return;
+                task = std::move(mTasks_.front());
+                mTasks_.pop_front();
+            }
+            task();
+        }
+    }
+}// namespace foxbatdb
@@ -0,0 +1,42 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace foxbatdb {
+    struct Command;
+
+    // 存储执行器：需读取数据文件的命令交给有界的工作线程池执行，避免冷数据的磁盘读取阻塞同一IO线程上的所有连接；
+    // 仅访问内存索引的命令（EXISTS、TTL等）与只追加写入的命令仍在IO线程上直接执行
+    class StorageExecutor {
+    public:
+        using Task = std::function<void()>;
+
+    private:
+        std::mutex mt_;
+        std::condition_variable mCond_;
+        std::deque<Task> mTasks_;
+        std::size_t mCapacity_ = 0;
+        bool mIsStopped_ = false;
+        std::vector<std::thread> mWorkers_;
+
+        StorageExecutor() = default;
+        void WorkerLoop();
+
+    public:
+        StorageExecutor(const StorageExecutor&) = delete;
+        StorageExecutor& operator=(const StorageExecutor&) = delete;
+        ~StorageExecutor();
+        static StorageExecutor& GetInstance();
+        void Init();
+
+        [[nodiscard]] bool IsEnabled() const;
+        [[nodiscard]] static bool IsStorageCmd(const Command& cmd);
+        // 队列已满或未启用时返回false，task保持不变，由调用方直接执行
+        bool TryPost(Task& task);
+    };
+}// namespace foxbatdb
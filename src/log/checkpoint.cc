@@ -0,0 +1,237 @@
+#include "checkpoint.h"
+#include "core/db.h"
+#include "flag/flags.h"
+#include "serverlog.h"
+#include "utils/binary.h"
+#include "utils/utils.h"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+
+namespace foxbatdb {
+    namespace {
+        // 文件格式（整数均为大端序）：
+        // magic | version | 数据文件表(文件名, 大小) | 覆盖到的日志位置(文件序号, 偏移量) |
+        // 各db索引(dbIdx, 条目数, 条目(key, 文件序号, 偏移量, 过期毫秒时间戳)) | crc32
+        constexpr std::string_view CHECKPOINT_MAGIC = "FOXBATCK";
+        constexpr std::uint32_t CHECKPOINT_VERSION = 1;
+        constexpr std::string_view CHECKPOINT_FILE_NAME = "foxbat.checkpoint";
+
+        std::string BaseName(const std::string& path) {
+            return std::filesystem::path{path}.filename().string();
+        }
+
+        struct CheckpointEntry {
+            std::uint8_t dbIdx;
+            std::string key;
+            std::uint32_t fileIdx;
+            std::uint64_t offset;
+            std::uint64_t expireAtMs;
+        };
+    }// namespace
+
+    IndexCheckpoint& IndexCheckpoint::GetInstance() {
+        static IndexCheckpoint instance;
+        return instance;
+    }
+
+    void IndexCheckpoint::Init() {}
+
+    std::string IndexCheckpoint::FilePath() const {
+        return Flags::GetInstance().dbLogFileDir + "/" + std::string{CHECKPOINT_FILE_NAME};
+    }
+
+    std::shared_lock<std::shared_mutex> IndexCheckpoint::LockForWrite() {
+        return std::shared_lock{mWriteBarrier_};
+    }
+
+    void IndexCheckpoint::DumpToDisk() {
+        if (Flags::GetInstance().diskIndexMode) return;
+        auto startTime = std::chrono::steady_clock::now();
+        auto& logFileManager = DataLogFileManager::GetInstance();
+
+        // 短暂阻塞写命令，记录日志位置；该位置之后的写入在回放时重做，索引快照本身无需阻塞写入
+        DataLogFile::Location coveredPos;
+        std::vector<std::pair<DataLogFile*, DataLogFile::OffsetType>> files;
+        {
+            std::unique_lock l{mWriteBarrier_};
+            auto* writableFile = logFileManager.GetWritableDataFile();
+            coveredPos = {writableFile, writableFile->EndOffset()};
+            for (auto* file: logFileManager.GetDataFiles()) {
+                // 空文件重启时不会被加载，不纳入文件表
+                if (auto size = file->EndOffset(); size > 0)
+                    files.emplace_back(file, size);
+            }
+        }
+        if (mLastCoveredPos_ == coveredPos) return;// 上次检查点之后没有新的写入
+
+        std::string buf{CHECKPOINT_MAGIC};
+        utils::AppendBigEndian(buf, CHECKPOINT_VERSION);
+
+        std::unordered_map<const DataLogFile*, std::uint32_t> fileIdxMap;
+        utils::AppendBigEndian(buf, static_cast<std::uint32_t>(files.size()));
+        for (const auto& [file, size]: files) {
+            fileIdxMap.emplace(file, static_cast<std::uint32_t>(fileIdxMap.size()));
+            utils::AppendLengthPrefixed(buf, BaseName(file->Name()));
+            utils::AppendBigEndian(buf, static_cast<std::uint64_t>(static_cast<std::streamoff>(size)));
+        }
+
+        // 可写文件为空时，从文件表之后的首个文件起回放
+        auto coveredIt = fileIdxMap.find(coveredPos.first);
+        utils::AppendBigEndian(buf, (coveredIt == fileIdxMap.end()) ? static_cast<std::uint32_t>(files.size()) : coveredIt->second);
+        utils::AppendBigEndian(buf, static_cast<std::uint64_t>(static_cast<std::streamoff>(coveredPos.second)));
+
+        auto& dbm = DatabaseManager::GetInstance();
+        std::size_t keyNum = 0;
+        utils::AppendBigEndian(buf, static_cast<std::uint8_t>(dbm.GetDBListSize()));
+        for (std::size_t dbIdx = 0; dbIdx < dbm.GetDBListSize(); ++dbIdx) {
+            utils::AppendBigEndian(buf, static_cast<std::uint8_t>(dbIdx));
+            auto entryNumPos = buf.size();
+            utils::AppendBigEndian(buf, std::uint64_t{0});
+
+            std::uint64_t entryNum = 0;
+            for (const auto& [key, valObj]: dbm.GetDBByIndex(dbIdx)->IndexSnapshot()) {
+                if (valObj->IsExpired()) continue;
+                auto meta = valObj->GetMeta();
+                // 位于文件表之外的记录必然写在覆盖位置之后，由回放恢复
+                auto it = fileIdxMap.find(meta.logFilePtr);
+                if ((it == fileIdxMap.end()) || (meta.pos < 0)) continue;
+
+                utils::AppendLengthPrefixed(buf, key);
+                utils::AppendBigEndian(buf, it->second);
+                utils::AppendBigEndian(buf, static_cast<std::uint64_t>(static_cast<std::streamoff>(meta.pos)));
+                utils::AppendBigEndian(buf, valObj->HasExpiration()
+                                                    ? utils::TimePointConvertToMillisecondTimestamp(meta.expirationTime)
+                                                    : std::uint64_t{0});
+                ++entryNum;
+            }
+            utils::OverwriteBigEndian(buf, entryNumPos, entryNum);
+            keyNum += entryNum;
+        }
+        utils::AppendBigEndian(buf, utils::CRC(buf.data(), buf.size()) ^ utils::CRC_INIT_VALUE);
+
+        // 先写临时文件再重命名，保证磁盘上的检查点始终完整
+        auto path = FilePath();
+        auto tmpPath = path + ".tmp";
+        {
+            std::ofstream out{tmpPath, std::ios::binary | std::ios::trunc};
+            out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+            out.flush();
+            if (!out) {
+                ServerLog::GetInstance().Error("index checkpoint write failed: {}", tmpPath);
+                return;
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) {
+            ServerLog::GetInstance().Error("index checkpoint rename failed: {}", ec.message());
+            return;
+        }
+
+        mLastCoveredPos_ = coveredPos;
+        ServerLog::GetInstance().Info(
+                "index checkpoint saved: {} keys, {} bytes, {} ms", keyNum, buf.size(),
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+    }
+
+    std::optional<IndexCheckpoint::ReplayPosition> IndexCheckpoint::LoadFromDisk(
+            const std::vector<DataLogFile*>& files) {
+        auto path = FilePath();
+        std::error_code ec;
+        auto fileSize = std::filesystem::file_size(path, ec);
+        if (ec) return std::nullopt;
+
+        // 一次性读入内存后解析
+        std::string buf(fileSize, '\0');
+        {
+            std::ifstream in{path, std::ios::binary};
+            in.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+            if (!in) return std::nullopt;
+        }
+
+        auto invalid = [&path](const char* reason) -> std::optional<ReplayPosition> {
+            ServerLog::GetInstance().Warning("index checkpoint {} ignored: {}", path, reason);
+            return std::nullopt;
+        };
+
+        if (buf.size() < CHECKPOINT_MAGIC.size() + sizeof(std::uint32_t))
+            return invalid("file truncated");
+        auto body = std::string_view{buf}.substr(0, buf.size() - sizeof(std::uint32_t));
+        if (utils::BinaryReader{std::string_view{buf}.substr(body.size())}.Read<std::uint32_t>() !=
+            (utils::CRC(body.data(), body.size()) ^ utils::CRC_INIT_VALUE))
+            return invalid("crc mismatch");
+
+        utils::BinaryReader reader{body.substr(CHECKPOINT_MAGIC.size())};
+        if (!body.starts_with(CHECKPOINT_MAGIC) || (reader.Read<std::uint32_t>() != CHECKPOINT_VERSION))
+            return invalid("unknown format");
+
+        // 检查点中的文件表须为当前数据文件的前缀；覆盖位置之前的文件不会再被追加，大小须不变
+        auto fileNum = reader.Read<std::uint32_t>();
+        if (fileNum > files.size())
+            return invalid("data files missing");
+        std::vector<std::uint64_t> fileSizes;
+        fileSizes.reserve(fileNum);
+        for (std::uint32_t i = 0; i < fileNum; ++i) {
+            auto name = reader.ReadLengthPrefixed();
+            fileSizes.emplace_back(reader.Read<std::uint64_t>());
+            if (!reader.OK()) return invalid("file truncated");
+            if (name != BaseName(files[i]->Name()))
+                return invalid("data files changed");
+        }
+
+        auto coveredFileIdx = reader.Read<std::uint32_t>();
+        auto coveredOffset = reader.Read<std::uint64_t>();
+        if (coveredFileIdx > fileNum)
+            return invalid("bad replay position");
+        for (std::uint32_t i = 0; i < fileNum; ++i) {
+            auto size = std::filesystem::file_size(files[i]->Name(), ec);
+            if (ec || (size < fileSizes[i]) || ((i < coveredFileIdx) && (size != fileSizes[i])))
+                return invalid("data files changed");
+        }
+
+        std::vector<CheckpointEntry> entries;
+        auto dbNum = reader.Read<std::uint8_t>();
+        for (std::uint8_t i = 0; (i < dbNum) && reader.OK(); ++i) {
+            auto dbIdx = reader.Read<std::uint8_t>();
+            auto entryNum = reader.Read<std::uint64_t>();
+            if (dbIdx >= DatabaseManager::GetInstance().GetDBListSize())
+                return invalid("db number changed");
+
+            for (std::uint64_t j = 0; (j < entryNum) && reader.OK(); ++j) {
+                CheckpointEntry entry{.dbIdx = dbIdx};
+                entry.key = std::string{reader.ReadLengthPrefixed()};
+                entry.fileIdx = reader.Read<std::uint32_t>();
+                entry.offset = reader.Read<std::uint64_t>();
+                entry.expireAtMs = reader.Read<std::uint64_t>();
+                if (entry.fileIdx >= fileNum)
+                    return invalid("bad record position");
+                entries.emplace_back(std::move(entry));
+            }
+        }
+        if (!reader.OK() || !reader.Empty())
+            return invalid("file truncated");
+
+        // 全部校验通过后再写入索引，避免加载一半的检查点污染索引
+        auto now = utils::GetMillisecondTimestamp();
+        auto& dbm = DatabaseManager::GetInstance();
+        for (const auto& entry: entries) {
+            if (entry.expireAtMs && (entry.expireAtMs <= now)) continue;
+            dbm.GetDBByIndex(entry.dbIdx)->LoadHistoryIndex(entry.key, MemoryIndex::HistoryDataInfo{
+                                                                               .logFilePtr = files[entry.fileIdx],
+                                                                               .pos = static_cast<std::streamoff>(entry.offset),
+                                                                               .expireAtMs = entry.expireAtMs});
+        }
+
+        ServerLog::GetInstance().Info("index checkpoint loaded: {} keys", entries.size());
+        return ReplayPosition{coveredFileIdx, static_cast<std::streamoff>(coveredOffset)};
+    }
+
+    void IndexCheckpoint::Invalidate() {
+        std::error_code ec;
+        std::filesystem::remove(FilePath(), ec);
+        mLastCoveredPos_.reset();
+    }
+}// namespace foxbatdb
@@ -0,0 +1,41 @@
+#pragma once
+#include "datalog.h"
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace foxbatdb {
+    // 内存索引检查点：定期将各db索引（key、所在数据文件、偏移量、过期时间）连同其覆盖到的数据日志位置写入磁盘，
+    // 重启时先加载检查点，再仅回放该位置之后的数据日志
+    class IndexCheckpoint {
+    public:
+        using ReplayPosition = std::pair<std::size_t, DataLogFile::OffsetType>;// 数据文件序号与偏移量
+
+    private:
+        std::shared_mutex mWriteBarrier_;
+        std::optional<DataLogFile::Location> mLastCoveredPos_;
+
+        IndexCheckpoint() = default;
+        [[nodiscard]] std::string FilePath() const;
+
+    public:
+        IndexCheckpoint(const IndexCheckpoint&) = delete;
+        IndexCheckpoint& operator=(const IndexCheckpoint&) = delete;
+        ~IndexCheckpoint() = default;
+        static IndexCheckpoint& GetInstance();
+        void Init();
+
+        // 写数据日志并更新索引期间持有，保证检查点记录的日志位置之前的写入均已反映在索引中
+        std::shared_lock<std::shared_mutex> LockForWrite();
+
+        void DumpToDisk();
+        // 加载检查点至各db索引，返回需开始回放的位置；检查点不存在或与数据文件不匹配时返回空
+        std::optional<ReplayPosition> LoadFromDisk(const std::vector<DataLogFile*>& files);
+        // 数据文件合并会改变记录位置，合并前删除检查点
+        void Invalidate();
+    };
+}// namespace foxbatdb
@@ -1,14 +1,18 @@
 #include "datalog.h"
+#include "checkpoint.h"
 #include "core/db.h"
 #include "flag/flags.h"
 #include "serverlog.h"
 #include "utils/utils.h"
+#include <algorithm>
 #include <filesystem>
 #include <iterator>
+#include <numeric>
 #include <regex>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 
 namespace foxbatdb {
     static constexpr std::string_view CFileNamePrefix = "foxbat-";
@@ -42,21 +46,30 @@ namespace foxbatdb {
             std::uint8_t dbIdx = 0;
             std::uint64_t keySize = 0;
             std::uint64_t valSize = 0;
+            std::uint64_t expireAt = 0;// ʱkExpirableData¼
+
+            [[nodiscard]] bool IsDataRecord() const {
+                return (RecordState::kData == txRuntimeState) || (RecordState::kExpirableData == txRuntimeState);
+            }
 
             bool LoadFromDisk(std::fstream& file, std::streampos pos) {
                 if (pos < 0)
                     return false;
 
-                file.seekg(pos, std::ios_base::beg);
+                // λĿλʱseekⶪԤ
+                if (file.tellg() != pos)
+                    file.seekg(pos, std::ios_base::beg);
                 file.read(reinterpret_cast<char*>(&this->crc), sizeof(this->crc));
                 file.read(reinterpret_cast<char*>(&this->timestamp), sizeof(this->timestamp));
                 file.read(reinterpret_cast<char*>(&this->txRuntimeState), sizeof(this->txRuntimeState));
                 file.read(reinterpret_cast<char*>(&this->dbIdx), sizeof(this->dbIdx));
                 file.read(reinterpret_cast<char*>(&this->keySize), sizeof(this->keySize));
                 file.read(reinterpret_cast<char*>(&this->valSize), sizeof(this->valSize));
+                if (RecordState::kExpirableData == txRuntimeState)
+                    file.read(reinterpret_cast<char*>(&this->expireAt), sizeof(this->expireAt));
                 this->TransferEndian();
 
-                if (RecordState::kData == txRuntimeState) {
+                if (IsDataRecord()) {
                     if (!this->ValidateFileRecordHeader())
                         return false;
                 } else {
@@ -75,13 +88,15 @@ namespace foxbatdb {
                 file.write(reinterpret_cast<const char*>(&this->dbIdx), sizeof(this->dbIdx));
                 file.write(reinterpret_cast<const char*>(&this->keySize), sizeof(this->keySize));
                 file.write(reinterpret_cast<const char*>(&this->valSize), sizeof(this->valSize));
+                if (RecordState::kExpirableData == txRuntimeState)
+                    file.write(reinterpret_cast<const char*>(&this->expireAt), sizeof(this->expireAt));
             }
 
-            void SetCRC(const std::string& k, const std::string& v) {
+            void SetCRC(const std::string& k, std::string_view v) {
                 crc = CalculateCRC32Value(k, v);
             }
 
-            bool CheckCRC(const std::string& k, const std::string& v) const {
+            bool CheckCRC(const std::string& k, std::string_view v) const {
                 return CalculateCRC32Value(k, v) == crc;
             }
 
@@ -93,16 +108,19 @@ namespace foxbatdb {
                 this->timestamp = utils::ChangeIntegralEndian(this->timestamp);
                 this->keySize = utils::ChangeIntegralEndian(this->keySize);
                 this->valSize = utils::ChangeIntegralEndian(this->valSize);
+                this->expireAt = utils::ChangeIntegralEndian(this->expireAt);
             }
 
         private:
-            std::uint32_t CalculateCRC32Value(const std::string& k, const std::string& v) const {
+            std::uint32_t CalculateCRC32Value(const std::string& k, std::string_view v) const {
                 auto crcVal = utils::CRC(reinterpret_cast<const char*>(&timestamp), sizeof(timestamp),
                                          utils::CRC_INIT_VALUE);
                 crcVal = utils::CRC(reinterpret_cast<const char*>(&dbIdx), sizeof(dbIdx), crcVal);
                 crcVal = utils::CRC(reinterpret_cast<const char*>(&txRuntimeState), sizeof(txRuntimeState), crcVal);
                 crcVal = utils::CRC(reinterpret_cast<const char*>(&keySize), sizeof(keySize), crcVal);
                 crcVal = utils::CRC(reinterpret_cast<const char*>(&valSize), sizeof(valSize), crcVal);
+                if (RecordState::kExpirableData == txRuntimeState)
+                    crcVal = utils::CRC(reinterpret_cast<const char*>(&expireAt), sizeof(expireAt), crcVal);
                 crcVal = utils::CRC(k.data(), k.length(), crcVal);
                 crcVal = utils::CRC(v.data(), v.length(), crcVal);
                 return crcVal ^ utils::CRC_INIT_VALUE;
@@ -112,7 +130,7 @@ namespace foxbatdb {
                 if (!utils::IsValidTimestamp(this->timestamp))
                     return false;
 
-                if (RecordState::kData != this->txRuntimeState)
+                if (!IsDataRecord())
                     return false;
 
                 if (this->dbIdx > Flags::GetInstance().dbMaxNum)
@@ -131,7 +149,7 @@ namespace foxbatdb {
                 if (!utils::IsValidTimestamp(this->timestamp))
                     return false;
 
-                if (RecordState::kData == this->txRuntimeState)
+                if (IsDataRecord())
                     return false;
 
                 if (this->dbIdx > Flags::GetInstance().dbMaxNum)
@@ -156,13 +174,13 @@ namespace foxbatdb {
 
             static void LoadFromDisk(FileRecordData& data, std::fstream& file,
                                      std::size_t keySize, std::size_t valSize) {
-                if (!keySize || !valSize) return;
-
+                // valSizeΪ0ļ¼Ϊɾ
                 data.key.resize(keySize);
                 data.value.resize(valSize);
 
                 file.read(data.key.data(), static_cast<std::streamsize>(keySize));
-                file.read(data.value.data(), static_cast<std::streamsize>(valSize));
+                if (valSize)
+                    file.read(data.value.data(), static_cast<std::streamsize>(valSize));
             }
         };
 
@@ -174,7 +192,7 @@ namespace foxbatdb {
                 if (!record.header.LoadFromDisk(file, pos))
                     return false;
 
-                if (RecordState::kData == record.header.txRuntimeState) {
+                if (record.header.IsDataRecord()) {
                     FileRecordData::LoadFromDisk(record.data, file, record.header.keySize, record.header.valSize);
                 }
 
@@ -196,6 +214,18 @@ namespace foxbatdb {
         return this->name;
     }
 
+    DataLogFile::OffsetType DataLogFile::EndOffset() {
+        std::unique_lock l{mt};
+        file.seekp(0, std::fstream::end);
+        return file.tellp();
+    }
+
+    void DataLogFile::SeekForRead(OffsetType offset) {
+        std::unique_lock l{mt};
+        file.clear();
+        file.seekg(offset, std::ios_base::beg);
+    }
+
     DataLogFile::OffsetType DataLogFile::GetRowBySequence(Data& data) {
         data.error = true;
 
@@ -215,7 +245,9 @@ namespace foxbatdb {
         data.error = false;
         data.timestamp = record.header.timestamp;
         data.dbIdx = record.header.dbIdx;
-        data.state = RecordState::kData;
+        // Ǽ¼ʵ״̬Աkeyݼ¼
+        data.state = record.header.IsDataRecord() ? RecordState::kData : record.header.txRuntimeState;
+        data.expireAtMs = record.header.expireAt;
 
         if (RecordState::kBegin == record.header.txRuntimeState)
             data.txNum = record.header.keySize;
@@ -233,6 +265,7 @@ namespace foxbatdb {
             return DataLogFile::Data{
                     .dbIdx = record.header.dbIdx,
                     .state = RecordState::kData,
+                    .expireAtMs = record.header.expireAt,
                     .key = std::move(record.data.key),
                     .value = std::move(record.data.value),
             };
@@ -240,16 +273,81 @@ namespace foxbatdb {
         return DataLogFile::Data{.error = true};
     }
 
-    DataLogFile::OffsetType DataLogFile::DumpToDisk(std::uint8_t dbIdx, const std::string& k, const std::string& v) {
+    std::vector<DataLogFile::Data> DataLogFile::GetDataByOffsets(const std::vector<OffsetType>& offsets) {
+        // ڼ¼ĿնСڸֵʱ˳seekʹ¼ϲΪһȡ
+        static constexpr std::streamoff MAX_MERGE_GAP = 4096;
+
+        std::vector<Data> result(offsets.size());
+        std::vector<std::size_t> order(offsets.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&offsets](std::size_t lhs, std::size_t rhs) {
+            return offsets[lhs] < offsets[rhs];
+        });
+
+        std::unique_lock l{mt};
+        for (auto idx: order) {
+            auto offset = offsets[idx];
+            auto cur = file.tellg();
+            if ((cur >= 0) && (offset > cur) && (offset - cur <= MAX_MERGE_GAP))
+                file.ignore(offset - cur);
+
+            FileRecord record;
+            if (!FileRecord::LoadFromDisk(record, file, offset)) {
+                file.clear();
+                result[idx].error = true;
+                continue;
+            }
+            result[idx] = DataLogFile::Data{
+                    .dbIdx = record.header.dbIdx,
+                    .state = RecordState::kData,
+                    .expireAtMs = record.header.expireAt,
+                    .key = std::move(record.data.key),
+                    .value = std::move(record.data.value),
+            };
+        }
+        file.seekp(0, std::fstream::end);
+        return result;
+    }
+
+    std::vector<DataLogFile::Data> DataLogFile::BatchGetData(const std::vector<Location>& locations) {
+        std::vector<Data> result(locations.size());
+
+        // ļ飬ÿڲƫȡ
+        std::unordered_map<DataLogFile*, std::vector<std::size_t>> groups;
+        for (std::size_t i = 0; i < locations.size(); ++i) {
+            if (!locations[i].first) {
+                result[i].error = true;
+                continue;
+            }
+            groups[locations[i].first].emplace_back(i);
+        }
+
+        // ڵǰ̶߳ȡΪỵ̈߳ȡļнĴ洢ִ̳߳
+        for (const auto& [logFile, indexes]: groups) {
+            std::vector<OffsetType> offsets;
+            offsets.reserve(indexes.size());
+            for (auto i: indexes)
+                offsets.emplace_back(locations[i].second);
+
+            auto data = logFile->GetDataByOffsets(offsets);
+            for (std::size_t j = 0; j < indexes.size(); ++j)
+                result[indexes[j]] = std::move(data[j]);
+        }
+        return result;
+    }
+
+    DataLogFile::OffsetType DataLogFile::DumpToDisk(std::uint8_t dbIdx, const std::string& k, std::string_view v,
+                                                    std::uint64_t expireAtMs) {
         std::unique_lock l{mt};
         DataLogFile::OffsetType pos = file.tellp();
         FileRecordHeader header{
                 .crc = 0,
                 .timestamp = utils::GetMicrosecondTimestamp(),
-                .txRuntimeState = RecordState::kData,
+                .txRuntimeState = expireAtMs ? RecordState::kExpirableData : RecordState::kData,
                 .dbIdx = dbIdx,
                 .keySize = k.length(),
-                .valSize = v.length()};
+                .valSize = v.length(),
+                .expireAt = expireAtMs};
         header.SetCRC(k, v);
         header.DumpToDisk(file);
 
@@ -259,6 +357,25 @@ namespace foxbatdb {
         return pos;
     }
 
+    void DataLogFile::DumpTombstonesToDisk(std::uint8_t dbIdx, const std::vector<std::string>& keys) {
+        if (keys.empty()) return;
+
+        std::unique_lock l{mt};
+        for (const auto& k: keys) {
+            FileRecordHeader header{
+                    .crc = 0,
+                    .timestamp = utils::GetMicrosecondTimestamp(),
+                    .txRuntimeState = RecordState::kData,
+                    .dbIdx = dbIdx,
+                    .keySize = k.length(),
+                    .valSize = 0};
+            header.SetCRC(k, "");
+            header.DumpToDisk(file);
+            file.write(k.data(), static_cast<std::streamsize>(k.length()));
+        }
+        file.flush();// ɾֻˢһ
+    }
+
     void DataLogFile::DumpTxFlagToDisk(std::uint8_t dbIdx, RecordState txFlag, std::size_t txCmdNum) {
         FileRecordHeader header{
                 .crc = 0,
@@ -329,6 +446,14 @@ namespace foxbatdb {
         return mWritableFileIter_->get();
     }
 
+    std::vector<DataLogFile*> DataLogFileManager::GetDataFiles() const {
+        std::unique_lock l{mt_};
+        std::vector<DataLogFile*> files;
+        for (const auto& file: mLogFilePool_)
+            files.emplace_back(file.get());
+        return files;
+    }
+
     void DataLogFileManager::PoolExpand() {
         auto poolSize = mLogFilePool_.size();
         for (std::size_t i = poolSize; i < 1 + poolSize; ++i) {
@@ -385,58 +510,15 @@ namespace foxbatdb {
         return true;
     }
 
-    static bool LoadHistoryTxFromDisk(DataLogFile* fileWrapper, std::uint64_t txNum) {
-        auto& dbm = DatabaseManager::GetInstance();
-
-        std::vector<std::pair<DataLogFile::OffsetType, DataLogFile::Data>> txRecords;
-        for (std::uint64_t i = 0; i < txNum; ++i) {
-            DataLogFile::Data txRecord;
-            auto offset = fileWrapper->GetRowBySequence(txRecord);
-            if (-1 == offset)
-                return false;
-
-            if (RecordState::kFailed == txRecord.state)
-                return true;
-            if (RecordState::kData != txRecord.state)
-                return false;
-            txRecords.emplace_back(offset, txRecord);
-        }
-
-        DataLogFile::Data txEndFlag;
-        if (-1 == fileWrapper->GetRowBySequence(txEndFlag))
-            return false;
-
-        if (RecordState::kFinish != txEndFlag.state)
-            return false;
-
-        for (const auto& [pos, record]: txRecords) {
-            if (!record.value.empty()) {
-                dbm.GetDBByIndex(record.dbIdx)
-                        ->LoadHistoryData(fileWrapper, pos, record);
-            }
-        }
-
-        return true;
-    }
-
     static void LoadHistoryRecordsFromSingleFile(DataLogFile* fileWrapper) {
         DataLogFile::Data data;
         auto offset = fileWrapper->GetRowBySequence(data);
         while (-1 != offset) {
-            if (RecordState::kData == data.state) {
-                // ָͨݼ¼
-                if (!data.value.empty())
-                    DatabaseManager::GetInstance()
-                            .GetDBByIndex(data.dbIdx)
-                            ->LoadHistoryData(fileWrapper, offset, data);
-            } else {
-                // ָ¼
-                if (RecordState::kBegin != data.state)
-                    break;
-
-                if (!LoadHistoryTxFromDisk(fileWrapper, data.txNum))
-                    break;
-            }
+            // ڵݼ¼عдĻָ¼ִ˳̣λطżɣǲݣ
+            if (RecordState::kData == data.state)
+                DatabaseManager::GetInstance()
+                        .GetDBByIndex(data.dbIdx)
+                        ->LoadHistoryData(fileWrapper, offset, data);
             offset = fileWrapper->GetRowBySequence(data);
         }
     }
@@ -446,14 +528,34 @@ namespace foxbatdb {
         if (!FillDataLogFilePoolByHistoryDataFile())
             return;
 
+        std::vector<DataLogFile*> files;
+        for (auto& fileWrapper: mLogFilePool_)
+            files.emplace_back(fileWrapper.get());
+
+        // ģʽ׸ļɺϲɣеkeyȫдΣطţ
+        // Чʱֻطż㸲λ֮ļ¼
+        std::size_t firstReplayFileIdx = 0;
+        bool keySegmentsLoaded = false;
+        if (Flags::GetInstance().diskIndexMode) {
+            keySegmentsLoaded = DatabaseManager::GetInstance().LoadKeySegments(files.front());
+            if (keySegmentsLoaded) firstReplayFileIdx = 1;
+        } else if (auto replayPos = IndexCheckpoint::GetInstance().LoadFromDisk(files); replayPos.has_value()) {
+            firstReplayFileIdx = replayPos->first;
+            if (firstReplayFileIdx < files.size())
+                files[firstReplayFileIdx]->SeekForRead(replayPos->second);
+        }
+
         // ζļdict
-        for (auto& fileWrapper: mLogFilePool_) {
-            LoadHistoryRecordsFromSingleFile(fileWrapper.get());
-            fileWrapper->ClearOSFlag();
+        for (auto i = firstReplayFileIdx; i < files.size(); ++i) {
+            LoadHistoryRecordsFromSingleFile(files[i]);
+            files[i]->ClearOSFlag();
         }
 
         // ÿļλ
         mWritableFileIter_ = std::prev(mLogFilePool_.end());
+        // ζӦļ׷д룬ʱ嵥¼ĴС
+        if (keySegmentsLoaded && (1 == mLogFilePool_.size()))
+            PoolExpand();
     }
 
     static std::unique_ptr<DataLogFile> CreateMergeLogFile() {
@@ -493,8 +595,13 @@ namespace foxbatdb {
 
         auto& dbm = DatabaseManager::GetInstance();
         if (auto mergeLogFile = CreateMergeLogFile(); mergeLogFile) {                    // mergeļ
-            dbm.Merge(mergeLogFile.get(), writableIterSnapshot->get());                  // ϲdbļ
+            IndexCheckpoint::GetInstance().Invalidate();                                 // ʹʧЧ
+            KeySegment::RemoveManifest();                                                // ʹʧЧ
+            auto* mergeLogFilePtr = mergeLogFile.get();
+            dbm.Merge(mergeLogFilePtr, writableIterSnapshot->get());                     // ϲdbļ
             this->ModifyDataFilesForMerge(writableIterSnapshot, std::move(mergeLogFile));// ޸Ĵļ֯
+            if (Flags::GetInstance().diskIndexMode)
+                dbm.CommitKeySegments(std::filesystem::file_size(mergeLogFilePtr->Name()));// ύ
         }
     }
 }// namespace foxbatdb
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 namespace foxbatdb {
@@ -11,12 +13,14 @@ namespace foxbatdb {
         kData = 0,
         kFailed,
         kBegin,
-        kFinish
+        kFinish,
+        kExpirableData// 携带绝对过期时间的数据记录
     };
 
     class DataLogFile {
     public:
         using OffsetType = std::fstream::pos_type;
+        using Location = std::pair<DataLogFile*, OffsetType>;
 
         struct Data {
             bool error = false;
@@ -24,6 +28,7 @@ namespace foxbatdb {
             std::uint8_t dbIdx = 0;
             RecordState state = RecordState::kData;
             std::uint16_t txNum = 0;
+            std::uint64_t expireAtMs = 0;
             std::string key;
             std::string value;
         };
@@ -32,10 +37,17 @@ namespace foxbatdb {
         explicit DataLogFile(const std::string& fileName);
 
         const std::string& Name() const;
+        OffsetType EndOffset();
+        void SeekForRead(OffsetType offset);// 顺序读取的起始位置
 
         OffsetType GetRowBySequence(Data& data);
         Data GetDataByOffset(OffsetType offset);
-        OffsetType DumpToDisk(std::uint8_t dbIdx, const std::string& k, const std::string& v);
+        // 批量读取，结果顺序与请求顺序一致
+        std::vector<Data> GetDataByOffsets(const std::vector<OffsetType>& offsets);
+        static std::vector<Data> BatchGetData(const std::vector<Location>& locations);
+        OffsetType DumpToDisk(std::uint8_t dbIdx, const std::string& k, std::string_view v,
+                              std::uint64_t expireAtMs = 0);
+        void DumpTombstonesToDisk(std::uint8_t dbIdx, const std::vector<std::string>& keys);
         void DumpTxFlagToDisk(std::uint8_t dbIdx, RecordState txFlag, std::size_t txCmdNum = 0);
 
         void Rename(const std::string& newName);
@@ -70,6 +82,7 @@ namespace foxbatdb {
         static DataLogFileManager& GetInstance();
         void Init();
         DataLogFile* GetWritableDataFile();
+        std::vector<DataLogFile*> GetDataFiles() const;
         void Merge();
     };
 }// namespace foxbatdb
\ No newline at end of file
@@ -17,25 +17,26 @@ namespace foxbatdb {
         return instance;
     }
 
-    static std::vector<std::string> CommandToCMDList(Command&& data) {
-        std::vector<std::string> cmdList = {data.name};
+    static std::vector<std::string> CommandToCMDList(const Command& data) {
+        std::vector<std::string> cmdList;
         cmdList.reserve(1 + data.argv.size() + data.options.size());
-        for (auto&& p: data.argv)
-            cmdList.emplace_back(std::move(p));
-        for (auto&& opt: data.options) {
+        cmdList.emplace_back(data.name);
+        for (auto p: data.argv)
+            cmdList.emplace_back(p);
+        for (const auto& opt: data.options) {
             cmdList.emplace_back(opt.name);
-            for (auto&& p: opt.argv)
-                cmdList.emplace_back(std::move(p));
+            for (auto p: opt.argv)
+                cmdList.emplace_back(p);
         }
         return cmdList;
     }
 
-    void OperationLog::AppendCommand(Command&& data) {
+    void OperationLog::AppendCommand(const Command& data) {
         if (mCmdBuffer_.IsFull()) {
             WriteAllCommands();// ζдosļ
         }
 
-        mCmdBuffer_.Enqueue(CommandToCMDList(std::move(data)));
+        mCmdBuffer_.Enqueue(CommandToCMDList(data));
     }
 
     void OperationLog::WriteAllCommands() {
@@ -69,7 +69,7 @@ namespace foxbatdb {
         ~OperationLog();
         static OperationLog& GetInstance();
         void Init();
-        void AppendCommand(Command&& data);
+        void AppendCommand(const Command& data);// ÷غdata
         void DumpToDisk();
     };
 }// namespace foxbatdb
\ No newline at end of file
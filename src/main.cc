@@ -1,8 +1,12 @@
 ﻿#include "core/db.h"
+#include "core/keypool.h"
 #include "core/memory.h"
+#include "core/tracking.h"
 #include "cron/cron.h"
 #include "flag/flags.h"
 #include "frontend/server.h"
+#include "frontend/storage.h"
+#include "log/checkpoint.h"
 #include "log/datalog.h"
 #include "log/oplog.h"
 #include "log/serverlog.h"
@@ -17,11 +21,8 @@ void OutOfMemoryHandler() {
 
 void MemoryAllocRetryFunc() {
     auto& dbm = DatabaseManager::GetInstance();
-    if (dbm.HaveMemoryAvailable()) {
-        dbm.ScanDBForReleaseMemory();
-    } else {
+    if (!dbm.HaveMemoryAvailable() || !dbm.ScanDBForReleaseMemory())
         OutOfMemoryHandler();
-    }
 }
 
 std::string ParseArgs(int argc, char** argv) {
@@ -41,10 +42,14 @@ void InitComponents(const std::string& flagConfPath) {
     Flags::GetInstance().Init(flagConfPath);
     ServerLog::GetInstance().Init();
     OperationLog::GetInstance().Init();
+    KeyPool::GetInstance().Init();// 先于持有key句柄的单例构造，保证其最后析构
+    ClientTracking::GetInstance().Init();
     DatabaseManager::GetInstance().Init();
+    IndexCheckpoint::GetInstance().Init();
     DataLogFileManager::GetInstance().Init();
     RecordObjectPool::GetInstance().Init();
     CronJobManager::GetInstance().Init();
+    StorageExecutor::GetInstance().Init();// 最后构造，先于其执行的命令所访问的组件析构
 }
 
 int main(int argc, char** argv) {
@@ -0,0 +1,72 @@
+#pragma once
+#include "utils.h"
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace foxbatdb::utils {
+    // 磁盘文件中的整数统一以大端序存储
+    template<std::integral T>
+    T ToBigEndian(T val) {
+        if constexpr ((sizeof(T) > 1) && (std::endian::native == std::endian::little))
+            return ChangeIntegralEndian(val);
+        else
+            return val;
+    }
+
+    template<std::integral T>
+    void AppendBigEndian(std::string& buf, T val) {
+        val = ToBigEndian(val);
+        buf.append(reinterpret_cast<const char*>(&val), sizeof(val));
+    }
+
+    template<std::integral T>
+    void OverwriteBigEndian(std::string& buf, std::size_t pos, T val) {
+        val = ToBigEndian(val);
+        std::memcpy(buf.data() + pos, &val, sizeof(val));
+    }
+
+    // 32位长度前缀 + 字节内容
+    inline void AppendLengthPrefixed(std::string& buf, std::string_view str) {
+        AppendBigEndian(buf, static_cast<std::uint32_t>(str.size()));
+        buf.append(str);
+    }
+
+    // 带越界检查的顺序读取，任一读取越界后OK()返回false
+    class BinaryReader {
+    private:
+        std::string_view mBuf_;
+        bool mOK_ = true;
+
+    public:
+        explicit BinaryReader(std::string_view buf) : mBuf_{buf} {}
+
+        [[nodiscard]] bool OK() const { return mOK_; }
+        [[nodiscard]] bool Empty() const { return mBuf_.empty(); }
+
+        template<std::integral T>
+        T Read() {
+            T val{};
+            if (mBuf_.size() < sizeof(T)) {
+                mOK_ = false;
+                return val;
+            }
+            std::memcpy(&val, mBuf_.data(), sizeof(T));
+            mBuf_.remove_prefix(sizeof(T));
+            return ToBigEndian(val);
+        }
+
+        std::string_view ReadLengthPrefixed() {
+            auto len = Read<std::uint32_t>();
+            if (!mOK_ || (mBuf_.size() < len)) {
+                mOK_ = false;
+                return {};
+            }
+            auto str = mBuf_.substr(0, len);
+            mBuf_.remove_prefix(len);
+            return str;
+        }
+    };
+}// namespace foxbatdb::utils
@@ -1,43 +1,50 @@
 #include "resp.h"
+#include <charconv>
 #include <cmath>
 
 namespace foxbatdb::detail {
-    static void BuildResponseHelper(std::string& resp, const std::string& content) {
+    static void BuildResponseHelper(std::string& resp, std::string_view content) {
         resp += content;
         resp += "\r\n";
     }
 
     static void BuildResponseHelper(std::string& resp, char prefix,
-                                    const std::string& content) {
+                                    std::string_view content) {
         resp += prefix;
         resp += content;
         resp += "\r\n";
     }
 
+    // 整数直接编码到resp末尾，不经过std::to_string的临时字符串
+    static void BuildNumberHelper(std::string& resp, char prefix, std::int64_t val) {
+        char buf[24];
+        auto [end, _] = std::to_chars(buf, buf + sizeof(buf), val);
+        resp += prefix;
+        resp.append(buf, end);
+        resp += "\r\n";
+    }
+
     void BuildSimpleErrorResp(std::string& resp, std::error_code err) {
         BuildResponseHelper(resp, '-', err.message());
     }
 
     void BuildBulkErrorResp(std::string& resp, std::error_code err) {
-        BuildResponseHelper(resp, '!', std::to_string(err.message().length()));
-        BuildResponseHelper(resp, err.message());
+        auto msg = err.message();
+        BuildNumberHelper(resp, '!', static_cast<std::int64_t>(msg.length()));
+        BuildResponseHelper(resp, msg);
     }
 
-    void BuildSimpleStringResp(std::string& resp, const char* data) {
-        BuildResponseHelper(resp, '+', std::string{data});
-    }
-
-    void BuildSimpleStringResp(std::string& resp, const std::string& data) {
+    void BuildSimpleStringResp(std::string& resp, std::string_view data) {
         BuildResponseHelper(resp, '+', data);
     }
 
-    void BuildBulkStringResp(std::string& resp, const std::string& data) {
-        BuildResponseHelper(resp, '!', std::to_string(data.length()));
+    void BuildBulkStringResp(std::string& resp, std::string_view data) {
+        BuildNumberHelper(resp, '!', static_cast<std::int64_t>(data.length()));
         BuildResponseHelper(resp, data);
     }
 
-    void BuildIntegerResp(std::string& resp, int val) {
-        BuildResponseHelper(resp, ':', std::to_string(val));
+    void BuildIntegerResp(std::string& resp, std::int64_t val) {
+        BuildNumberHelper(resp, ':', val);
     }
 
     void BuildBooleanResp(std::string& resp, bool val) {
@@ -69,12 +76,21 @@ namespace foxbatdb::detail {
 
     void BuildArrayResp(std::string& resp,
                         const std::vector<std::string>& params) {
-        BuildResponseHelper(resp, '*', std::to_string(params.size()));
+        std::size_t totalSize = resp.size();
+        for (const auto& param: params)
+            totalSize += param.size();
+        resp.reserve(totalSize + 24);
+
+        BuildArrayHeaderResp(resp, params.size());
         for (const auto& param: params) {
             resp += param;
         }
     }
 
+    void BuildArrayHeaderResp(std::string& resp, std::size_t size) {
+        BuildNumberHelper(resp, '*', static_cast<std::int64_t>(size));
+    }
+
     void BuildNilResp(std::string& resp) {
         resp += "$-1";
         resp += "\r\n";
@@ -86,7 +102,7 @@ namespace foxbatdb::detail {
 
     void BuildSetResp(std::string& resp,
                       const std::vector<std::string>& elements) {
-        BuildResponseHelper(resp, '~', std::to_string(elements.size()));
+        BuildNumberHelper(resp, '~', static_cast<std::int64_t>(elements.size()));
         for (const auto& e: elements) {
             resp += e;
         }
@@ -95,7 +111,7 @@ namespace foxbatdb::detail {
     void BuildMapResp(
             std::string& resp,
             const std::vector<std::pair<std::string, std::string>>& data) {
-        BuildResponseHelper(resp, '%', std::to_string(data.size()));
+        BuildNumberHelper(resp, '%', static_cast<std::int64_t>(data.size()));
         for (const auto& [key, val]: data) {
             resp += key;
             resp += val;
@@ -104,7 +120,7 @@ namespace foxbatdb::detail {
 
     void BuildPushesResp(std::string& resp,
                          const std::vector<std::string>& outOfBandData) {
-        BuildResponseHelper(resp, '>', std::to_string(outOfBandData.size()));
+        BuildNumberHelper(resp, '>', static_cast<std::int64_t>(outOfBandData.size()));
         for (const auto& e: outOfBandData) {
             resp += e;
         }
@@ -1,5 +1,7 @@
 #pragma once
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <system_error>
 #include <type_traits>
 #include <utility>
@@ -9,10 +11,9 @@ namespace foxbatdb {
     namespace detail {
         void BuildSimpleErrorResp(std::string& resp, std::error_code err);
         void BuildBulkErrorResp(std::string& resp, std::error_code err);
-        void BuildSimpleStringResp(std::string& resp, const char* data);
-        void BuildSimpleStringResp(std::string& resp, const std::string& data);
-        void BuildBulkStringResp(std::string& resp, const std::string& data);
-        void BuildIntegerResp(std::string& resp, int val);
+        void BuildSimpleStringResp(std::string& resp, std::string_view data);
+        void BuildBulkStringResp(std::string& resp, std::string_view data);
+        void BuildIntegerResp(std::string& resp, std::int64_t val);
         void BuildBooleanResp(std::string& resp, bool val);
         void BuildDoubleResp(std::string& resp, double val);
 
@@ -25,6 +26,7 @@ namespace foxbatdb {
         void BuildNullResp(std::string& resp);
         void BuildArrayResp(std::string& resp,
                             const std::vector<std::string>& params);
+        void BuildArrayHeaderResp(std::string& resp, std::size_t size);// Ԫɵ÷ֱ׷
 
         void BuildSetResp(std::string& resp, const std::vector<std::string>& elements);
         void BuildMapResp(
@@ -33,11 +35,10 @@ namespace foxbatdb {
         void BuildPushesResp(std::string& resp,
                              const std::vector<std::string>& outOfBandData);
 
-        // RESP
+        // RESPֱ׷ӵrespĩβ
         template<typename T>
         struct ResponseBuilder {
-            std::string operator()(const T& data) {
-                std::string resp;
+            void operator()(std::string& resp, const T& data) {
                 if constexpr (std::is_same_v<bool, T>) {
                     BuildBooleanResp(resp, data);
                 } else if constexpr (std::is_same_v<float, T> || std::is_same_v<double, T>) {
@@ -57,6 +58,11 @@ namespace foxbatdb {
                 } else {
                     static_assert(data.NOT_EXISTS_METHOD());
                 }
+            }
+
+            std::string operator()(const T& data) {
+                std::string resp;
+                (*this)(resp, data);
                 return resp;
             }
         };
@@ -80,6 +86,16 @@ namespace foxbatdb {
             return detail::ResponseBuilder<T>{}(data);
         }
 
+        // Ӧֱӱ뵽respĩβԪعӦÿԪʱַ帴
+        template<typename T>
+        void AppendResponse(std::string& resp, const T& data) {
+            detail::ResponseBuilder<T>{}(resp, data);
+        }
+
+        inline void AppendArrayHeader(std::string& resp, std::size_t size) {
+            detail::BuildArrayHeaderResp(resp, size);
+        }
+
         template<typename... Args>
         std::string BuildPubSubResponse(const Args&... args) {
             std::string resp;
@@ -1,6 +1,14 @@
 #include "utils.h"
+#include <algorithm>
 #include <chrono>
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#elif defined(_WIN32)
+#include <windows.h>
+#endif
+
 namespace foxbatdb::utils {
     std::uint64_t GetMicrosecondTimestamp() {
         return std::chrono::duration_cast<std::chrono::microseconds>(
@@ -8,10 +16,23 @@ namespace foxbatdb::utils {
                 .count();
     }
 
-    std::chrono::steady_clock::time_point MicrosecondTimestampConvertToTimePoint(
+    std::uint64_t GetMillisecondTimestamp() {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::system_clock::now().time_since_epoch())
+                .count();
+    }
+
+    // ǽʱsteady_clockʱ㻥תԵǰʱΪ׼
+    std::chrono::steady_clock::time_point MillisecondTimestampConvertToTimePoint(
             std::uint64_t timestamp) {
-        return std::chrono::steady_clock::time_point{
-                std::chrono::microseconds{timestamp}};
+        auto nowMs = static_cast<std::int64_t>(GetMillisecondTimestamp());
+        auto diff = std::chrono::milliseconds{static_cast<std::int64_t>(timestamp) - nowMs};
+        return std::chrono::steady_clock::now() + diff;
+    }
+
+    std::uint64_t TimePointConvertToMillisecondTimestamp(std::chrono::steady_clock::time_point tp) {
+        auto diff = std::chrono::duration_cast<std::chrono::milliseconds>(tp - std::chrono::steady_clock::now());
+        return static_cast<std::uint64_t>(static_cast<std::int64_t>(GetMillisecondTimestamp()) + diff.count());
     }
 
     bool IsValidTimestamp(std::uint64_t timestamp) {
@@ -21,6 +42,80 @@ namespace foxbatdb::utils {
         return timestamp <= utils::GetMicrosecondTimestamp();
     }
 
+    namespace {
+        // ƥ[...]ַpiָ'['֮ƥɺָ']'֮
+        bool MatchCharClass(const std::string& pattern, std::size_t& pi, char ch) {
+            bool negate = false;
+            if ((pi < pattern.size()) && ('^' == pattern[pi])) {
+                negate = true;
+                ++pi;
+            }
+
+            bool matched = false;
+            while ((pi < pattern.size()) && (']' != pattern[pi])) {
+                if (('\\' == pattern[pi]) && (pi + 1 < pattern.size())) {
+                    ++pi;
+                    matched |= (pattern[pi] == ch);
+                    ++pi;
+                } else if ((pi + 2 < pattern.size()) && ('-' == pattern[pi + 1]) && (']' != pattern[pi + 2])) {
+                    auto [lo, hi] = std::minmax(pattern[pi], pattern[pi + 2]);
+                    matched |= ((lo <= ch) && (ch <= hi));
+                    pi += 3;
+                } else {
+                    matched |= (pattern[pi] == ch);
+                    ++pi;
+                }
+            }
+            if (pi < pattern.size()) ++pi;// ']'
+            return matched != negate;
+        }
+    }// namespace
+
+    bool GlobMatch(const std::string& pattern, const std::string& str) {
+        std::size_t pi = 0, si = 0;
+        std::size_t starPi = std::string::npos, starSi = 0;
+
+        while (si < str.size()) {
+            if (pi < pattern.size()) {
+                auto p = pattern[pi];
+                if ('*' == p) {
+                    // ¼ݵ㣬ȳƥմ
+                    starPi = pi++;
+                    starSi = si;
+                    continue;
+                }
+                if ('?' == p) {
+                    ++pi;
+                    ++si;
+                    continue;
+                }
+                if ('[' == p) {
+                    auto next = pi + 1;
+                    if (MatchCharClass(pattern, next, str[si])) {
+                        pi = next;
+                        ++si;
+                        continue;
+                    }
+                } else {
+                    if (('\\' == p) && (pi + 1 < pattern.size())) p = pattern[pi + 1];
+                    if (p == str[si]) {
+                        pi += ('\\' == pattern[pi] && pi + 1 < pattern.size()) ? 2 : 1;
+                        ++si;
+                        continue;
+                    }
+                }
+            }
+            // ʧ䣬һ*һַ
+            if (std::string::npos == starPi) return false;
+            pi = starPi + 1;
+            si = ++starSi;
+        }
+
+        while ((pi < pattern.size()) && ('*' == pattern[pi]))
+            ++pi;
+        return pi == pattern.size();
+    }
+
     // CRC32㷨
     static std::uint32_t CRC32Table[256];
 
@@ -49,4 +144,26 @@ namespace foxbatdb::utils {
         }
         return crcVal;
     }
+
+    bool SetCurrentThreadAffinity(const std::vector<std::size_t>& cpus) {
+        if (cpus.empty()) return true;
+#if defined(__linux__)
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for (auto cpu: cpus) {
+            if (cpu >= CPU_SETSIZE) return false;
+            CPU_SET(cpu, &cpuSet);
+        }
+        return 0 == pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#elif defined(_WIN32)
+        DWORD_PTR mask = 0;
+        for (auto cpu: cpus) {
+            if (cpu >= sizeof(mask) * 8) return false;
+            mask |= DWORD_PTR{1} << cpu;
+        }
+        return 0 != SetThreadAffinityMask(GetCurrentThread(), mask);
+#else
+        return false;
+#endif
+    }
 }// namespace foxbatdb::utils
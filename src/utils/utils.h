@@ -7,23 +7,33 @@
 #include <fstream>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace foxbatdb::utils {
     std::uint64_t GetMicrosecondTimestamp();
-    std::chrono::steady_clock::time_point MicrosecondTimestampConvertToTimePoint(std::uint64_t timestamp);
+    std::uint64_t GetMillisecondTimestamp();
+    std::chrono::steady_clock::time_point MillisecondTimestampConvertToTimePoint(std::uint64_t timestamp);
+    std::uint64_t TimePointConvertToMillisecondTimestamp(std::chrono::steady_clock::time_point tp);
     bool IsValidTimestamp(std::uint64_t timestamp);
 
+    // glob风格匹配，支持*、?、[...]，\用于转义
+    bool GlobMatch(const std::string& pattern, const std::string& str);
+
     constexpr unsigned long long operator"" _KB(unsigned long long m) { return m * 1024; }
     constexpr unsigned long long operator"" _MB(unsigned long long m) { return m * 1024 * 1024; }
 
     static constexpr std::uint32_t CRC_INIT_VALUE = 0xFFFFFFFF;
     std::uint32_t CRC(const char* buf, std::size_t size, std::uint32_t lastCRC = CRC_INIT_VALUE);
 
+    // 将当前线程绑定到cpus中的CPU上；cpus为空时不做处理，平台不支持或绑定失败时返回false
+    bool SetCurrentThreadAffinity(const std::vector<std::size_t>& cpus);
+
     template<typename T>
     concept Number = std::is_integral_v<T> || std::is_floating_point_v<T>;
 
     template<typename T> requires Number<T>
-    std::optional<T> ToNumber(const std::string& data) {
+    std::optional<T> ToNumber(std::string_view data) {
         T ret;
         auto [_, ec] = std::from_chars(data.data(), data.data() + data.size(), ret);
         if (ec != std::errc()) {
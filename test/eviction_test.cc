@@ -0,0 +1,115 @@
+// 淘汰策略测试：volatile-*策略只淘汰设置了过期时间的key，volatile-ttl按剩余生存时间从短到长淘汰，
+// allkeys-lru淘汰最久未访问的key，noeviction不淘汰任何key
+// 用法：eviction_test，全部通过时返回0
+#include "core/engine.h"
+#include "core/memory.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <string>
+
+namespace foxbatdb::test {
+    int failedNum = 0;
+
+    void Expect(bool cond, const char* caseName, const char* what) {
+        if (cond) return;
+        std::fprintf(stderr, "[%s] check failed: %s\n", caseName, what);
+        ++failedNum;
+    }
+
+    // ttl为0表示不设置过期时间
+    void Write(MaxMemoryStrategy& strategy, const std::string& key, std::chrono::seconds ttl) {
+        RecordObject obj;
+        if (ttl.count())
+            obj.SetExpiration(ttl);
+        strategy.UpdateStateForWriteOp(key, obj);
+    }
+
+    // volatile-*策略：未设置过期时间的key，以及改写为持久key的key，均不会被淘汰
+    void TestVolatileNeverEvictsPersistentKey(MaxMemoryStrategy& strategy, const char* caseName) {
+        using namespace std::chrono_literals;
+        Write(strategy, "persist", 0s);
+        Write(strategy, "was-volatile", 60s);
+        Write(strategy, "was-volatile", 0s);
+        Write(strategy, "volatile", 60s);
+        Write(strategy, "deleted", 60s);
+        strategy.UpdateStateForDelOp("deleted");
+        strategy.UpdateStateForReadOp("persist");
+
+        Expect(strategy.HaveMemoryAvailable(), caseName, "volatile key is evictable");
+        Expect(strategy.EvictKey() == "volatile", caseName, "evict the only volatile key");
+        Expect(!strategy.HaveMemoryAvailable(), caseName, "nothing left to evict");
+        Expect(!strategy.EvictKey().has_value(), caseName, "persistent keys are never evicted");
+    }
+
+    void TestVolatileTTLEvictsSoonestExpiring() {
+        using namespace std::chrono_literals;
+        constexpr const char* caseName = "volatile-ttl order";
+        VolatileTTLStrategy strategy;
+        Write(strategy, "late", 300s);
+        Write(strategy, "soon", 100s);
+        Write(strategy, "persist", 0s);
+        Write(strategy, "mid", 200s);
+        Write(strategy, "extended", 50s);
+        Write(strategy, "extended", 400s);// 重新设置的过期时间生效
+
+        Expect(strategy.EvictKey() == "soon", caseName, "soonest expiring key first");
+        Expect(strategy.EvictKey() == "mid", caseName, "then the next soonest");
+        Expect(strategy.EvictKey() == "late", caseName, "then the next soonest");
+        Expect(strategy.EvictKey() == "extended", caseName, "rewritten ttl is used");
+        Expect(!strategy.EvictKey().has_value(), caseName, "persistent key is never evicted");
+    }
+
+    void TestLRUEvictsLeastRecentlyUsed() {
+        using namespace std::chrono_literals;
+        constexpr const char* caseName = "allkeys-lru order";
+        LRUStrategy strategy;
+        Write(strategy, "a", 0s);
+        Write(strategy, "b", 60s);
+        Write(strategy, "c", 0s);
+        strategy.UpdateStateForReadOp("a");
+
+        Expect(strategy.EvictKey() == "b", caseName, "least recently used key first");
+        Expect(strategy.EvictKey() == "c", caseName, "then the next least recently used");
+        Expect(strategy.EvictKey() == "a", caseName, "read key is evicted last");
+        Expect(!strategy.EvictKey().has_value(), caseName, "nothing left to evict");
+    }
+
+    void TestNoeviction() {
+        using namespace std::chrono_literals;
+        constexpr const char* caseName = "noeviction";
+        NoevictionStrategy strategy;
+        Write(strategy, "volatile", 60s);
+
+        Expect(!strategy.HaveMemoryAvailable(), caseName, "never frees memory");
+        Expect(!strategy.EvictKey().has_value(), caseName, "never evicts");
+    }
+}// namespace foxbatdb::test
+
+int main() {
+    using namespace foxbatdb;
+    {
+        VolatileLRUStrategy strategy;
+        test::TestVolatileNeverEvictsPersistentKey(strategy, "volatile-lru");
+    }
+    {
+        VolatileTTLStrategy strategy;
+        test::TestVolatileNeverEvictsPersistentKey(strategy, "volatile-ttl");
+    }
+    {
+        VolatileRandomStrategy strategy;
+        test::TestVolatileNeverEvictsPersistentKey(strategy, "volatile-random");
+    }
+    test::TestVolatileTTLEvictsSoonestExpiring();
+    test::TestLRUEvictsLeastRecentlyUsed();
+    test::TestNoeviction();
+
+    if (test::failedNum) {
+        std::fprintf(stderr, "%d check(s) failed\n", test::failedNum);
+        return EXIT_FAILURE;
+    }
+    std::printf("all eviction checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -3,6 +3,13 @@ import unittest
 import redis
 import utils
 import copy
+import os
+import re
+import shutil
+import signal
+import socket
+import subprocess
+import tempfile
 import time
 from typing import Dict
 from threading import Thread
@@ -10,6 +17,8 @@ from threading import Thread
 DBHost = "localhost"
 DBPort = 7698
 MaximumStrSize: int = 1024
+# 需要重启或特殊配置的用例自行启动该可执行文件，未设置时跳过
+FoxbatDBBinary = os.environ.get("FOXBATDB_BIN", "")
 
 
 def generateTestDataSet(dataSetSize: int) -> Dict[str, str]:
@@ -22,6 +31,37 @@ def generateTestDataSet(dataSetSize: int) -> Dict[str, str]:
     return dataset
 
 
+def checkConcurrentScan(test: unittest.TestCase, clients: list):
+    # 多个客户端以相同的COUNT遍历同一前缀，每轮交换先后顺序，每步之间删除已越过的key：
+    # 相同的游标数值在不同客户端对应不同的续扫位置，各自的遍历互不干扰，始终存在的key不能被遗漏
+    prefix = "scanconc:" + utils.generateRandomStr(16) + ":"
+    keys = [prefix + "%04d" % i for i in range(400)]
+    for k in keys:
+        test.assertTrue(clients[0].set(k, "v"))
+    stable, volatile = set(keys[0::2]), keys[1::2]
+
+    seen = [set() for _ in clients]
+    cursors = [0 for _ in clients]
+    done = [False for _ in clients]
+    order = list(range(len(clients)))
+    while not all(done):
+        for i in order:
+            if done[i]:
+                continue
+            cursors[i], page = clients[i].scan(cursors[i], match=prefix + "*", count=7)
+            seen[i].update(page)
+            done[i] = (0 == cursors[i])
+            for _ in range(2):
+                if volatile:
+                    clients[0].delete(volatile.pop(0))
+        order.reverse()
+    for keySet in seen:
+        test.assertTrue(stable.issubset(keySet))
+
+    for k in keys:
+        clients[0].delete(k)
+
+
 class TestKeyValueOperators(unittest.TestCase):
     DataSetSize: int = 128
 
@@ -54,6 +94,21 @@ class TestKeyValueOperators(unittest.TestCase):
         for k, v in dataset.items():
             self.assertFalse(self.client.exists(k))
 
+    def test_ttl(self):
+        expireSeconds: int = 100
+        k = utils.generateRandomStr(MaximumStrSize)
+        self.assertTrue(self.client.set(k, k, ex=expireSeconds))
+        time.sleep(1)
+
+        ttl = self.client.ttl(k)
+        self.assertTrue(0 < ttl < expireSeconds)
+
+        self.assertTrue(self.client.set(k, k, keepttl=True))
+        self.assertTrue(0 < self.client.pttl(k) < expireSeconds * 1000)
+
+        self.assertTrue(self.client.set(k, k))
+        self.assertEqual(-1, self.client.ttl(k))
+
     def test_set_nx(self):
         dataset = generateTestDataSet(TestKeyValueOperators.DataSetSize)
         cnt = 0
@@ -137,6 +192,8 @@ class TestKeyValueOperators(unittest.TestCase):
         self.client.select(1)
         for k, v in dataset.items():
             self.assertEqual(v, self.client.get(k))
+        # 客户端为各用例共享，切回0号db，后续依赖索引引擎的用例才能按预期执行
+        self.client.select(0)
 
     def test_getrange(self):
         MaximumStrSize = 10
@@ -157,6 +214,155 @@ class TestKeyValueOperators(unittest.TestCase):
         for _, v in dataset.items():
             self.assertTrue(v in data)
 
+    def test_scan(self):
+        prefix = "scan:" + utils.generateRandomStr(16) + ":"
+        dataset = generateTestDataSet(TestKeyValueOperators.DataSetSize)
+        for k, v in dataset.items():
+            self.assertTrue(self.client.set(prefix + k, v))
+
+        keys = set(self.client.scan_iter(match=prefix + "*", count=7))
+        self.assertEqual({prefix + k for k in dataset.keys()}, keys)
+
+    def test_scan_with_delete(self):
+        # 遍历期间删除其他key，始终存在的key不能被遗漏
+        for db in (0, 1):
+            client = redis.Redis(host=DBHost, port=DBPort, db=db, decode_responses=True, protocol=3)
+            prefix = "scandel:" + utils.generateRandomStr(16) + ":"
+            keys = [prefix + "%04d" % i for i in range(400)]
+            for k in keys:
+                self.assertTrue(client.set(k, "v"))
+            stable, volatile = set(keys[0::2]), keys[1::2]
+
+            seen = set()
+            cursor = 0
+            while True:
+                cursor, page = client.scan(cursor, match=prefix + "*", count=7)
+                seen.update(page)
+                for _ in range(5):
+                    if volatile:
+                        client.delete(volatile.pop())
+                if 0 == cursor:
+                    break
+            self.assertTrue(stable.issubset(seen))
+
+            for k in keys:
+                client.delete(k)
+            client.close()
+
+    def test_scan_concurrent(self):
+        for db in (0, 1):
+            clients = [redis.Redis(host=DBHost, port=DBPort, db=db, decode_responses=True, protocol=3) for _ in range(2)]
+            checkConcurrentScan(self, clients)
+            for client in clients:
+                client.close()
+
+    def test_scan_invalid_cursor(self):
+        # 有序引擎的游标是服务端分配的续扫令牌，未知的游标返回错误而不是按位置续扫
+        client = redis.Redis(host=DBHost, port=DBPort, db=1, decode_responses=True, protocol=3)
+        with self.assertRaises(redis.ResponseError):
+            client.scan(123456789, count=7)
+        client.close()
+
+    def test_pscan(self):
+        prefix = "pscan:" + utils.generateRandomStr(16) + ":"
+        dataset = generateTestDataSet(TestKeyValueOperators.DataSetSize)
+        for k, v in dataset.items():
+            self.assertTrue(self.client.set(prefix + k, v))
+
+        data = {}
+        cursor = "0"
+        while True:
+            cursor, kvList = self.client.execute_command("PSCAN", cursor, prefix, "COUNT", 7)
+            for i in range(0, len(kvList), 2):
+                data[kvList[i]] = kvList[i + 1]
+            if int(cursor) == 0:
+                break
+        self.assertEqual({prefix + k: v for k, v in dataset.items()}, data)
+
+    def test_prefix(self):
+        prefix = "prefix:" + utils.generateRandomStr(16) + ":"
+        dataset = generateTestDataSet(TestKeyValueOperators.DataSetSize)
+        for k, v in dataset.items():
+            self.assertTrue(self.client.set(prefix + k, v))
+
+        kvList = self.client.execute_command("PREFIX", prefix)
+        data = {kvList[i]: kvList[i + 1] for i in range(0, len(kvList), 2)}
+        self.assertEqual({prefix + k: v for k, v in dataset.items()}, data)
+
+    def test_prefixkeys_prefixcount(self):
+        prefix = "pkeys:" + utils.generateRandomStr(16) + ":"
+        dataset = generateTestDataSet(TestKeyValueOperators.DataSetSize)
+        for k, v in dataset.items():
+            self.assertTrue(self.client.set(prefix + k, v))
+
+        keys = self.client.execute_command("PREFIXKEYS", prefix)
+        self.assertEqual({prefix + k for k in dataset.keys()}, set(keys))
+        self.assertEqual(10, len(self.client.execute_command("PREFIXKEYS", prefix, "LIMIT", 10)))
+        self.assertEqual(TestKeyValueOperators.DataSetSize, self.client.execute_command("PREFIXCOUNT", prefix))
+
+    def test_range(self):
+        # flag.toml中1号db使用ordered索引引擎
+        client = redis.Redis(host=DBHost, port=DBPort, db=1, decode_responses=True, protocol=3)
+        prefix = "range:" + utils.generateRandomStr(16) + ":"
+        dataset = {prefix + "%04d" % i: utils.generateRandomStr(16) for i in range(100)}
+        for k, v in dataset.items():
+            self.assertTrue(client.set(k, v))
+
+        start, end = prefix + "0010", prefix + "0019"
+        expected = [k for k in sorted(dataset.keys()) if start <= k <= end]
+
+        kvList = client.execute_command("RANGE", start, end)
+        self.assertEqual(expected, kvList[0::2])
+        self.assertEqual([dataset[k] for k in expected], kvList[1::2])
+
+        kvList = client.execute_command("REVRANGE", start, end, "LIMIT", 3)
+        self.assertEqual(list(reversed(expected))[:3], kvList[0::2])
+
+        self.assertEqual(sorted(dataset.keys()), client.execute_command("PREFIX", prefix)[0::2])
+        client.close()
+
+        with self.assertRaises(redis.exceptions.ResponseError):
+            self.client.execute_command("RANGE", start, end)
+
+    def test_hash_index(self):
+        # flag.toml中2号db使用hash索引引擎
+        client = redis.Redis(host=DBHost, port=DBPort, db=2, decode_responses=True, protocol=3)
+        prefix = "hash:" + utils.generateRandomStr(16) + ":"
+        dataset = {prefix + "%04d" % i: utils.generateRandomStr(16) for i in range(100)}
+        for k, v in dataset.items():
+            self.assertTrue(client.set(k, v))
+        for k, v in dataset.items():
+            self.assertEqual(v, client.get(k))
+
+        self.assertEqual(set(dataset.keys()), set(client.scan_iter(match=prefix + "*", count=7)))
+
+        for cmd in (["PREFIX", prefix], ["PREFIXKEYS", prefix], ["PREFIXCOUNT", prefix],
+                    ["PSCAN", 0, prefix], ["RANGE", prefix, prefix + "~"]):
+            with self.assertRaises(redis.exceptions.ResponseError):
+                client.execute_command(*cmd)
+
+        for k in dataset.keys():
+            self.assertEqual(1, client.delete(k))
+        client.close()
+
+    def test_hash_index_empty_key(self):
+        # 空key是合法的key，须与其他key一样写入、读取和删除
+        client = redis.Redis(host=DBHost, port=DBPort, db=2, decode_responses=True, protocol=3)
+        self.assertTrue(client.set("", "empty"))
+        self.assertEqual("empty", client.get(""))
+        self.assertEqual(1, client.delete(""))
+        self.assertEqual(0, client.exists(""))
+        self.assertEqual(0, client.delete(""))
+        client.close()
+
+    def test_set_invalid_expire(self):
+        # 过期时间须为正，换算为毫秒级绝对时间后不得溢出
+        k = utils.generateRandomStr(MaximumStrSize)
+        for opts in ({"ex": 0}, {"px": -1}, {"ex": 2 ** 62}, {"px": 2 ** 63 - 1}):
+            with self.assertRaises(redis.ResponseError):
+                self.client.set(k, k, **opts)
+        self.assertFalse(self.client.exists(k))
+
     def test_strlen(self):
         dataset = generateTestDataSet(TestKeyValueOperators.DataSetSize)
         for k, v in dataset.items():
@@ -218,6 +424,50 @@ class TestKeyValueOperators(unittest.TestCase):
             self.client.decrby(k, n)
         self.assertEqual(str(-sum(num)), self.client.get(k))
 
+    def test_pipeline(self):
+        # 一次发送的多条命令须按序返回各自的响应
+        dataset = generateTestDataSet(TestKeyValueOperators.DataSetSize)
+        pipe = self.client.pipeline(transaction=False)
+        for k, v in dataset.items():
+            pipe.set(k, v)
+            pipe.get(k)
+        replies = pipe.execute()
+        self.assertEqual(2 * len(dataset), len(replies))
+        for i, v in enumerate(dataset.values()):
+            self.assertTrue(replies[2 * i])
+            self.assertEqual(v, replies[2 * i + 1])
+
+        pipe = self.client.pipeline(transaction=False)
+        for k in dataset.keys():
+            pipe.delete(k)
+        self.assertEqual([1] * len(dataset), pipe.execute())
+
+    def test_pipeline_half_close(self):
+        # 客户端发送完请求后关闭写方向，已读取请求的响应须全部写出后才关闭连接
+        k = utils.generateRandomStr(MaximumStrSize)
+        v = utils.generateRandomStr(8 * MaximumStrSize)
+        self.assertTrue(self.client.set(k, v))
+
+        def sendThenHalfClose(req: bytes) -> bytes:
+            with socket.create_connection((DBHost, DBPort)) as sock:
+                sock.sendall(req)
+                sock.shutdown(socket.SHUT_WR)
+                # 暂不读取，服务端读到EOF时仍有响应积压在连接的输出缓冲区中
+                time.sleep(0.5)
+                received = bytearray()
+                while chunk := sock.recv(65536):
+                    received += chunk
+                return bytes(received)
+
+        get = f"*2\r\n$3\r\nGET\r\n${len(k)}\r\n{k}\r\n".encode()
+        reply = sendThenHalfClose(get)
+        self.assertIn(v.encode(), reply)
+        # 末尾的MGET响应远超套接字缓冲区，须在读到EOF后继续写出
+        num = 200
+        mget = f"*{num + 1}\r\n$4\r\nMGET\r\n".encode() + f"${len(k)}\r\n{k}\r\n".encode() * num
+        self.assertEqual(reply * 16 + f"*{num}\r\n".encode() + reply * num, sendThenHalfClose(get * 16 + mget))
+        self.assertEqual(1, self.client.delete(k))
+
 
 class TestTransaction(unittest.TestCase):
     DataSetSize: int = 16
@@ -278,6 +528,24 @@ class TestTransaction(unittest.TestCase):
             self.assertEqual(str(cnt), self.client.get(k))
             cnt += 1
 
+    def test_tx_watch_active_expire(self):
+        # 主动过期删除被watch的key时，已入队的事务须放弃执行
+        watched = "tx-watch-" + utils.generateRandomStr(16)
+        marker = "tx-marker-" + utils.generateRandomStr(16)
+        client = redis.Redis(host=DBHost, port=DBPort, decode_responses=True, protocol=3)
+        self.assertTrue(client.set(watched, "v", px=200))
+        client.execute_command("WATCH", watched)
+        client.execute_command("MULTI")
+        client.execute_command("SET", marker, "1")
+        # 等待期间不访问该key，只能由主动过期删除
+        time.sleep(1)
+        try:
+            client.execute_command("EXEC")
+        except redis.ResponseError:
+            pass
+        self.assertEqual(0, self.client.exists(marker))
+        client.close()
+
 
 class TestPubSub(unittest.TestCase):
     DataSetSize: int = 128
@@ -316,6 +584,67 @@ class TestPubSub(unittest.TestCase):
         client2.close()
 
 
+class TestClientTracking(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.client = redis.Redis(host=DBHost, port=DBPort, decode_responses=True, protocol=3)
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.client.close()
+
+    # 使用原始socket收发，以便直接检查服务端推送的invalidate消息
+    @staticmethod
+    def encodeCommand(*args: str) -> bytes:
+        cmd = f"*{len(args)}\r\n"
+        for arg in args:
+            cmd += f"${len(arg)}\r\n{arg}\r\n"
+        return cmd.encode()
+
+    @staticmethod
+    def recvExactly(sock: socket.socket, size: int) -> bytes:
+        data = b""
+        while len(data) < size:
+            chunk = sock.recv(size - len(data))
+            if not chunk:
+                break
+            data += chunk
+        return data
+
+    @staticmethod
+    def invalidateMsg(key: str) -> bytes:
+        return f">2\r\n+invalidate\r\n*1\r\n+{key}\r\n".encode()
+
+    def test_tracking_keys(self):
+        key = utils.generateRandomStr(16)
+        self.assertTrue(self.client.set(key, "v1"))
+
+        with socket.create_connection((DBHost, DBPort), timeout=5.0) as sock:
+            sock.sendall(self.encodeCommand("CLIENT", "TRACKING", "ON"))
+            self.assertEqual(b"+OK\r\n", self.recvExactly(sock, 5))
+            sock.sendall(self.encodeCommand("GET", key))
+            self.assertEqual(b"+v1\r\n", self.recvExactly(sock, 5))
+
+            # 其他连接修改已读取的key后收到失效消息
+            self.assertTrue(self.client.set(key, "v2"))
+            msg = self.invalidateMsg(key)
+            self.assertEqual(msg, self.recvExactly(sock, len(msg)))
+
+    def test_tracking_bcast(self):
+        prefix = utils.generateRandomStr(8) + ":"
+        key = prefix + utils.generateRandomStr(8)
+
+        with socket.create_connection((DBHost, DBPort), timeout=5.0) as sock:
+            sock.sendall(self.encodeCommand("CLIENT", "TRACKING", "ON", "BCAST", "PREFIX", prefix))
+            self.assertEqual(b"+OK\r\n", self.recvExactly(sock, 5))
+
+            # 广播模式无需读取，前缀匹配的key被修改、删除时均收到失效消息
+            self.assertTrue(self.client.set(key, "v"))
+            self.assertEqual(1, self.client.delete(key))
+            msg = self.invalidateMsg(key)
+            self.assertEqual(msg + msg, self.recvExactly(sock, len(msg) * 2))
+
+
 class TestDataLogFileMerge(unittest.TestCase):
     DataSetSize: int = 128
 
@@ -361,5 +690,153 @@ class TestDataLogFileMerge(unittest.TestCase):
             cnt += 1
 
 
+class DBServerProcess:
+    """以独立的配置与数据目录启动FoxbatDB进程，配置项取自config/flag.toml，可按名称覆盖"""
+
+    def __init__(self, port: int, **overrides):
+        self.port = port
+        self.workDir = tempfile.mkdtemp(prefix="foxbatdb-test-")
+        self.confPath = os.path.join(self.workDir, "flag.toml")
+        self.proc = None
+
+        settings = {
+            "listenPort": port,
+            "serverLogPath": os.path.join(self.workDir, "foxbatdb.log"),
+            "aofLogFilePath": os.path.join(self.workDir, "foxbatdb.oplog"),
+            "dbFileDirectory": os.path.join(self.workDir, "db"),
+        }
+        settings.update(overrides)
+        os.makedirs(settings["dbFileDirectory"])
+
+        confTemplate = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "config", "flag.toml")
+        with open(confTemplate, encoding="utf-8") as f:
+            lines = f.readlines()
+        with open(self.confPath, "w", encoding="utf-8") as f:
+            for line in lines:
+                m = re.match(r"^(\w+)\s*=", line)
+                if m and m.group(1) in settings:
+                    val = settings[m.group(1)]
+                    line = f'{m.group(1)} = {val}\n' if isinstance(val, int) else f'{m.group(1)} = "{val}"\n'
+                f.write(line)
+
+    def start(self):
+        self.proc = subprocess.Popen([FoxbatDBBinary, f"--flag-conf-path={self.confPath}"])
+        deadline = time.time() + 10
+        while time.time() < deadline:
+            try:
+                socket.create_connection((DBHost, self.port), timeout=1).close()
+                return
+            except OSError:
+                time.sleep(0.1)
+        raise RuntimeError("foxbatdb did not start listening")
+
+    def stop(self):
+        if self.proc:
+            self.proc.send_signal(signal.SIGTERM)
+            self.proc.wait(timeout=10)
+            self.proc = None
+
+    def restart(self):
+        self.stop()
+        self.start()
+
+    def client(self, db: int = 0) -> redis.Redis:
+        return redis.Redis(host=DBHost, port=self.port, db=db, decode_responses=True, protocol=3)
+
+    def cleanup(self):
+        self.stop()
+        shutil.rmtree(self.workDir, ignore_errors=True)
+
+
+@unittest.skipUnless(FoxbatDBBinary, "FOXBATDB_BIN is not set")
+class TestRestart(unittest.TestCase):
+    def setUp(self):
+        self.server = DBServerProcess(DBPort + 1)
+        self.server.start()
+
+    def tearDown(self):
+        self.server.cleanup()
+
+    def test_ttl_counts_down_across_restart(self):
+        # 数据文件记录绝对过期时间，重启期间生存时间照常流逝
+        client = self.server.client()
+        self.assertTrue(client.set("ttl-key", "v", px=4000))
+        client.close()
+        time.sleep(1.5)
+        self.server.restart()
+
+        client = self.server.client()
+        self.assertTrue(0 < client.pttl("ttl-key") <= 2500)
+        self.assertEqual("v", client.get("ttl-key"))
+        time.sleep(3)
+        self.assertEqual(0, client.exists("ttl-key"))
+        client.close()
+
+    def test_expired_while_down(self):
+        # 停机期间过期的记录在加载时视为删除，之前写入的同名旧值不得复活
+        client = self.server.client()
+        self.assertTrue(client.set("down-key", "old"))
+        self.assertTrue(client.set("down-key", "new", px=500))
+        client.close()
+        self.server.stop()
+        time.sleep(1)
+        self.server.start()
+
+        client = self.server.client()
+        self.assertEqual(0, client.exists("down-key"))
+        self.assertEqual(-2, client.pttl("down-key"))
+        client.close()
+
+
+@unittest.skipUnless(FoxbatDBBinary, "FOXBATDB_BIN is not set")
+class TestARTIndex(unittest.TestCase):
+    def setUp(self):
+        # dbEngines未列出的db使用defaultEngine
+        self.server = DBServerProcess(DBPort + 1, defaultEngine="art")
+        self.server.start()
+
+    def tearDown(self):
+        self.server.cleanup()
+
+    def test_scan_concurrent(self):
+        clients = [self.server.client(3) for _ in range(2)]
+        checkConcurrentScan(self, clients)
+        for client in clients:
+            client.close()
+
+
+@unittest.skipUnless(FoxbatDBBinary, "FOXBATDB_BIN is not set")
+class TestActiveExpire(unittest.TestCase):
+    KeyNum: int = 1000
+    KeySize: int = 64
+
+    def setUp(self):
+        # 关闭合并与检查点，数据目录的大小只随写入增长
+        self.server = DBServerProcess(DBPort + 1, dbFileMergeCronJobPeriodMs=3600000,
+                                      indexCheckpointCronJobPeriodMs=0)
+        self.server.start()
+        self.dbDir = os.path.join(self.server.workDir, "db")
+
+    def tearDown(self):
+        self.server.cleanup()
+
+    def dataSize(self) -> int:
+        return sum(os.path.getsize(os.path.join(self.dbDir, name)) for name in os.listdir(self.dbDir))
+
+    def test_unread_keys_expire(self):
+        client = self.server.client()
+        pipe = client.pipeline(transaction=False)
+        for i in range(TestActiveExpire.KeyNum):
+            pipe.set(f"{i:0{TestActiveExpire.KeySize}d}", "v", px=200)
+        pipe.execute()
+        sizeBefore = self.dataSize()
+
+        # 不读取任何key，过期删除只能由后台周期任务完成，每个key写入一条含key的删除标记
+        time.sleep(1.5)
+        self.assertGreaterEqual(self.dataSize() - sizeBefore, TestActiveExpire.KeyNum * TestActiveExpire.KeySize)
+        self.assertEqual(0, client.execute_command("PREFIXCOUNT", ""))
+        client.close()
+
+
 if __name__ == '__main__':
     unittest.main()
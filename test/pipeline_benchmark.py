@@ -0,0 +1,59 @@
+# coding=utf-8
+import redis
+import time
+import utils
+from typing import List
+
+'''
+    Pipelined throughput of FoxbatDB vs Redis: python pipeline_benchmark.py
+    A server that is not listening (FoxbatDB on 7698, Redis on 6379) is skipped.
+    Each depth sends CommandNum SET (then GET) commands in batches of that many commands per round trip.
+'''
+
+CommandNum = 100000
+ValueSize = 128
+PipelineDepthList = [1, 4, 16, 64, 256]
+KeySpace = 10000
+
+
+def BenchmarkPipeline(clt: redis.client.Redis, depth: int, cmd: str) -> float:
+    keys = ["pipeline:" + str(i) for i in range(KeySpace)]
+    value = utils.generateRandomStr(ValueSize)
+
+    start = time.perf_counter()
+    sent = 0
+    while sent < CommandNum:
+        pipe = clt.pipeline(transaction=False)
+        for i in range(sent, min(sent + depth, CommandNum)):
+            if cmd == 'SET':
+                pipe.set(keys[i % KeySpace], value)
+            else:
+                pipe.get(keys[i % KeySpace])
+        pipe.execute()
+        sent += depth
+    return CommandNum / (time.perf_counter() - start)
+
+
+def RunBenchmark(clt: redis.client.Redis) -> List[List[float]]:
+    return [[BenchmarkPipeline(clt, depth, cmd) for depth in PipelineDepthList] for cmd in ('SET', 'GET')]
+
+
+def Connect(port: int):
+    clt = redis.Redis(host='localhost', port=port, decode_responses=True, protocol=3)
+    try:
+        clt.exists('pipeline:0')
+    except redis.exceptions.ConnectionError:
+        print('no server on port {}, skipped'.format(port))
+        return None
+    return clt
+
+
+if __name__ == '__main__':
+    servers = {'FoxbatDB': Connect(7698), 'Redis': Connect(6379)}
+    results = {server: RunBenchmark(clt) for server, clt in servers.items() if clt is not None}
+
+    print('{:<10}{:<6}'.format('server', 'cmd') + ''.join('{:>12}'.format('P=' + str(d)) for d in PipelineDepthList))
+    for server, (setOps, getOps) in results.items():
+        for cmd, ops in (('SET', setOps), ('GET', getOps)):
+            print('{:<10}{:<6}'.format(server, cmd) + ''.join('{:>12.0f}'.format(v) for v in ops))
+    print('(ops/sec)')